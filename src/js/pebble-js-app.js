@@ -1,11 +1,500 @@
 (function(Pebble, window) {
   var settings = {};
 
+  // Must match PADDLE_EASE_STEPS and paddle_ease in pingchrong.c, and the sizes in pingchrong.h
+  var PADDLE_EASE_STEPS = 16,
+      PADDLE_EASE = [0, 3, 11, 24, 40, 59, 81, 104, 128, 152, 175, 197, 216, 232, 245, 253, 256],
+      BALL_RADIUS = 2,
+      PADDLE_W = 3,
+      BAR_HEIGHT = 2,
+      BAR_MARGIN = 2;
+
+  // Keyframe flags; must match MIRROR_LEFT_LOSES etc. in pingchrong.c
+  var MIRROR_LEFT_LOSES = 1 << 0,
+      MIRROR_RIGHT_LOSES = 1 << 1,
+      MIRROR_MISS_ABOVE = 1 << 2,
+      MIRROR_LEFT_PLANNED = 1 << 3,
+      MIRROR_RIGHT_PLANNED = 1 << 4,
+      MIRROR_ROUND = 1 << 5;
+
+  // Last game state received from the watch; see mirror_send_keyframe in pingchrong.c
+  var mirror = null;
+
+  // Watch frame the last keyframe was for, and when it arrived (used to pace playback)
+  var mirrorClock = null;
+
+  // Companion page the mirrored match is relayed to (see README), and the timer that paces it
+  var mirrorSocket = null,
+      mirrorTimer = null;
+
+  // Settings that stay on the phone rather than being sent to the watch
+  var PHONE_SETTINGS = ["mirrorUrl"];
+
+  // Settings page, opened as a data URI so it shows without a network round trip. It
+  // reads the current settings from the '#' hash and hands them back the same way.
+  var SETTINGS_PAGE = [
+    '<!DOCTYPE html>',
+    '<html>',
+    '<head>',
+    '  <title>Pebble PingChrong Settings</title>',
+    '  <meta charset="utf-8">',
+    '  <meta name="viewport" content="width=device-width, initial-scale=1">',
+    '  <style>',
+    '    body { margin: 0; font-family: Helvetica, Arial, sans-serif; background: #f9f9f9; color: #333; }',
+    '    h1 { margin: 0; padding: 12px; font-size: 18px; text-align: center; color: #fff; background: #222; }',
+    '    .content { padding: 8px 16px; }',
+    '    .field { display: flex; align-items: center; justify-content: space-between; padding: 12px 0; border-bottom: 1px solid #ddd; }',
+    '    .field label { font-weight: bold; }',
+    '    .field select, .field input { min-width: 80px; padding: 6px; font-size: 16px; }',
+    '    .error { display: none; margin: 8px 0; padding: 12px; color: #fff; background: #c33; border-radius: 4px; }',
+    '    .buttons { display: flex; padding: 16px; }',
+    '    .buttons button { flex: 1; margin: 0 4px; padding: 12px; font-size: 16px; border: 1px solid #222; border-radius: 4px; }',
+    '    #b-cancel { color: #222; background: #fff; }',
+    '    #b-submit { color: #fff; background: #222; }',
+    '  </style>',
+    '</head>',
+    '<body>',
+    '  <h1>PingChrong Settings</h1>',
+    '',
+    '  <div class="content">',
+    '    <div class="error" id="error">Sorry! I failed to understand the settings sent to me from your Pebble app.</div>',
+    '',
+    '    <div class="field">',
+    '      <label for="12h-time">12H time:</label>',
+    '      <select name="12h-time" id="12h-time" data-key="12hTime">',
+    '        <option value="0">No</option>',
+    '        <option value="1">Yes</option>',
+    '      </select>',
+    '    </div>',
+    '',
+    '    <div class="field">',
+    '      <label for="inverted">Inverted:</label>',
+    '      <select name="inverted" id="inverted" data-key="inverted">',
+    '        <option value="0">No</option>',
+    '        <option value="1">Yes</option>',
+    '      </select>',
+    '    </div>',
+    '',
+    '    <div class="field">',
+    '      <label for="mirror">Mirror to phone:</label>',
+    '      <select name="mirror" id="mirror" data-key="mirror">',
+    '        <option value="0">No</option>',
+    '        <option value="1">Yes</option>',
+    '      </select>',
+    '    </div>',
+    '',
+    '    <div class="field">',
+    '      <label for="mirror-url">Mirror to page:</label>',
+    '      <input type="url" name="mirror-url" id="mirror-url" data-key="mirrorUrl" placeholder="ws://">',
+    '    </div>',
+    '',
+    '    <div class="field">',
+    '      <label for="ball-speed">Ball speed:</label>',
+    '      <select name="ball-speed" id="ball-speed" data-key="ballSpeed">',
+    '        <option value="50">Slow</option>',
+    '        <option value="75">Medium</option>',
+    '        <option value="100" selected>Fast</option>',
+    '      </select>',
+    '    </div>',
+    '',
+    '    <div class="field">',
+    '      <label for="paddle-size">Paddle size:</label>',
+    '      <select name="paddle-size" id="paddle-size" data-key="paddleSize">',
+    '        <option value="15">Small</option>',
+    '        <option value="20" selected>Normal</option>',
+    '        <option value="30">Large</option>',
+    '      </select>',
+    '    </div>',
+    '',
+    '    <div class="field">',
+    '      <label for="paddle-speed">Paddle speed (average):</label>',
+    '      <select name="paddle-speed" id="paddle-speed" data-key="paddleSpeed">',
+    '        <option value="8">Slow</option>',
+    '        <option value="10" selected>Normal</option>',
+    '        <option value="20">Fast</option>',
+    '      </select>',
+    '    </div>',
+    '',
+    '    <div class="field">',
+    '      <label for="frame-time">Frame rate:</label>',
+    '      <select name="frame-time" id="frame-time" data-key="frameTime">',
+    '        <option value="100">10 fps</option>',
+    '        <option value="50" selected>20 fps</option>',
+    '        <option value="33">30 fps</option>',
+    '      </select>',
+    '    </div>',
+    '  </div>',
+    '',
+    '  <div class="buttons">',
+    '    <button type="button" id="b-cancel">Cancel</button>',
+    '    <button type="button" id="b-submit">Save</button>',
+    '  </div>',
+    '',
+    '  <script>',
+    '    (function(document) {',
+    '      var fields = document.querySelectorAll("[data-key]");',
+    '',
+    '      // The option marked selected, or else the first',
+    '      function defaultValue(select) {',
+    '        var i;',
+    '        for (i = 0; i < select.options.length; i++) {',
+    '          if (select.options[i].defaultSelected) {',
+    '            return select.options[i].value;',
+    '          }',
+    '        }',
+    '        return select.options[0].value;',
+    '      }',
+    '',
+    '      function saveOptions() {',
+    '        var options = {}, i;',
+    '        for (i = 0; i < fields.length; i++) {',
+    '          // selects hold numbers; text fields are kept as they are',
+    '          options[fields[i].getAttribute("data-key")] = fields[i].tagName === "SELECT" ?',
+    '            parseInt(fields[i].selectedIndex < 0 ? defaultValue(fields[i]) : fields[i].value, 10) : fields[i].value;',
+    '        }',
+    '        return options;',
+    '      }',
+    '',
+    '      function loadOptions(settings) {',
+    '        var i, key;',
+    '        for (i = 0; i < fields.length; i++) {',
+    '          key = fields[i].getAttribute("data-key");',
+    '          if (settings[key] !== undefined) {',
+    '            fields[i].value = settings[key];',
+    '            // a value the page does not offer (say, stored by another version) leaves a select blank',
+    '            if (fields[i].tagName === "SELECT" && fields[i].selectedIndex < 0) {',
+    '              fields[i].value = defaultValue(fields[i]);',
+    '            }',
+    '          }',
+    '        }',
+    '      }',
+    '',
+    '      var settings = decodeURIComponent(window.location.hash.replace(/^#/, ""));',
+    '',
+    '      if (settings) {',
+    '        try {',
+    '          loadOptions(JSON.parse(JSON.parse(settings)));',
+    '        } catch(e) {',
+    '          console.log("JSON parsing error:", e);',
+    '          document.getElementById("error").style.display = "block";',
+    '        }',
+    '      }',
+    '',
+    '      document.getElementById("error").onclick = function() {',
+    '        this.style.display = "none";',
+    '      };',
+    '',
+    '      document.getElementById("b-cancel").onclick = function() {',
+    '        document.location = "pebblejs://close";',
+    '      };',
+    '',
+    '      document.getElementById("b-submit").onclick = function() {',
+    '        document.location = "pebblejs://close#" + encodeURIComponent(JSON.stringify(saveOptions()));',
+    '      };',
+    '    })(document);',
+    '  </script>',
+    '</body>',
+    '</html>'
+  ].join("\n");
+
+  function readInt8(data, i) {
+    return data[i] > 0x7F ? data[i] - 0x100 : data[i];
+  }
+
+  function readUint16(data, i) {
+    return data[i] | (data[i + 1] << 8);
+  }
+
+  function readInt16(data, i) {
+    var v = readUint16(data, i);
+    return v > 0x7FFF ? v - 0x10000 : v;
+  }
+
+  function readMotion(data, i) {
+    return {
+      startY: readInt16(data, i),
+      deltaY: readInt16(data, i + 2),
+      phase: readUint16(data, i + 4),
+      phaseStep: readUint16(data, i + 6)
+    };
+  }
+
+  function paddleY(motion) {
+    var i = motion.phase >> 8,
+        ease = PADDLE_EASE[i];
+    if(i < PADDLE_EASE_STEPS) {
+      ease += ((PADDLE_EASE[i + 1] - PADDLE_EASE[i]) * (motion.phase & 0xFF)) >> 8;
+    }
+    return motion.startY + ((motion.deltaY * ease / 256) | 0);
+  }
+
+  function stepMotion(motion) {
+    var end = PADDLE_EASE_STEPS << 8;
+    if(motion.phase < end) {
+      motion.phase = Math.min(motion.phase + motion.phaseStep, end);
+    }
+  }
+
+  // A float stored into a uint8_t on the watch
+  function toUint8(value) {
+    return Math.trunc(value) & 0xFF;
+  }
+
+  // Walls of a round table, one per column; see init_geometry in pingchrong.c
+  function roundWalls(m, leftFace, rightFace) {
+    var radius = (Math.min(m.width, m.height) >> 1) - BAR_MARGIN - BAR_HEIGHT - BALL_RADIUS - 1,
+        centerX = m.width >> 1,
+        centerY = m.height >> 1,
+        top = [],
+        bottom = [],
+        x, dx, half;
+    for(x = 0; x < m.width; x++) {
+      dx = Math.min(Math.max(x, leftFace), rightFace) - centerX;
+      half = dx * dx < radius * radius ? Math.floor(Math.sqrt(radius * radius - dx * dx)) : 0;
+      top.push(Math.max(centerY - half, m.ballTop));
+      bottom.push(Math.min(centerY + half, m.ballBottom));
+    }
+    return { top: top, bottom: bottom };
+  }
+
+  function readKeyframe(data) {
+    var flags = data[10],
+        m = {
+          frame: (data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24)) >>> 0,
+          x: readInt16(data, 4),
+          y: readInt16(data, 6),
+          dx: readInt8(data, 8),
+          dy: readInt8(data, 9),
+          missAbove: (flags & MIRROR_MISS_ABOVE) !== 0,
+          width: data[11],
+          height: data[12],
+          ballTop: data[13],
+          ballBottom: data[14],
+          paddleTop: data[17],
+          paddleBottom: data[18],
+          paddleH: data[19],
+          paddleSpeed: data[20],
+          out: false
+        };
+    m.left = { dir: -1, x: data[15], face: data[15] + PADDLE_W + BALL_RADIUS, loses: (flags & MIRROR_LEFT_LOSES) !== 0,
+               planned: (flags & MIRROR_LEFT_PLANNED) !== 0, bouncepos: 0, endpos: 0, motion: readMotion(data, 21) };
+    m.right = { dir: 1, x: data[16], face: data[16] - BALL_RADIUS - 1, loses: (flags & MIRROR_RIGHT_LOSES) !== 0,
+                planned: (flags & MIRROR_RIGHT_PLANNED) !== 0, bouncepos: 0, endpos: 0, motion: readMotion(data, 29) };
+    m.walls = (flags & MIRROR_ROUND) ? roundWalls(m, m.left.face, m.right.face) : null;
+    return m;
+  }
+
+  function wallColumn(m, x) {
+    return x < 0 ? 0 : (x >= m.width ? m.width - 1 : Math.trunc(x));
+  }
+
+  function wallTop(m, x) {
+    return m.walls ? m.walls.top[wallColumn(m, x)] : m.ballTop;
+  }
+
+  function wallBottom(m, x) {
+    return m.walls ? m.walls.bottom[wallColumn(m, x)] : m.ballBottom;
+  }
+
+  // The watch's keepout_solve (keepout.h), in single precision like the watch
+  function solveKeepout(m, side) {
+    var f = Math.fround,
+        left = m.left.x,
+        right = m.right.x + PADDLE_W,
+        x = m.x, y = m.y, dx = m.dx, dy = m.dy,
+        bounceY = 0, collided = false, ticks = 0,
+        oldX, oldY, wall, hitDx, hitDy;
+    while(f(f(x + BALL_RADIUS) + 1) < right && f(x + BALL_RADIUS) > left) {
+      oldX = x;
+      oldY = y;
+      y = f(y + dy);
+      x = f(x + dx);
+      wall = wallBottom(m, x);
+      if(y > wall) {
+        y = wall;
+        dy = -dy;
+      }
+      wall = wallTop(m, x) + 1;
+      if(y < wall) {
+        y = wall;
+        dy = -dy;
+      }
+      if(!collided && f(f(x - side.face) * side.dir) >= 0) {
+        hitDx = f(side.face - oldX);
+        hitDy = f(f(hitDx / dx) * dy);
+        bounceY = f(oldY + hitDy);
+        collided = true;
+      }
+      if(!collided) {
+        ticks = (ticks + 1) & 0xFF;
+      }
+    }
+    if(collided) {
+      side.bouncepos = toUint8(bounceY);
+    }
+    side.endpos = toUint8(y);
+    return ticks;
+  }
+
+  // See plan_paddle_motion in pingchrong.c
+  function planMotion(m, side, toY, ticks) {
+    var fromY = paddleY(side.motion),
+        duration = ticks > 2 ? ticks - 1 : 1,
+        minDuration;
+    toY = Math.min(Math.max(toY, m.paddleTop), m.paddleBottom);
+    minDuration = (((Math.abs(toY - fromY) + m.paddleSpeed - 1) / m.paddleSpeed) | 0) & 0xFF;
+    duration = Math.max(duration, minDuration);
+    side.motion = {
+      startY: fromY,
+      deltaY: toY - fromY,
+      phase: 0,
+      phaseStep: (((PADDLE_EASE_STEPS << 8) + duration - 1) / duration) | 0
+    };
+  }
+
+  function intersects(x1, y1, w1, h1, x2, y2, w2, h2) {
+    return !(x1 + w1 < x2 || x2 + w2 < x1 || y1 + h1 < y2 || y2 + h2 < y1);
+  }
+
+  // See update_paddle in pingchrong.c
+  function updatePaddle(m, side) {
+    var f = Math.fround,
+        hitDx, hitDy, top, bottom, above, below, dest, ticks;
+    if((m.x - side.face) * side.dir >= 0 && (m.prevX - side.face) * side.dir <= 0) {
+      hitDx = side.face - m.prevX;
+      hitDy = f(f(hitDx / m.dx) * m.dy);
+      if(intersects(toUint8(side.face - BALL_RADIUS), toUint8(f(f(m.prevY + hitDy) - BALL_RADIUS)), BALL_RADIUS * 2 + 1, BALL_RADIUS * 2 + 1,
+                    side.x & 0xFF, paddleY(side.motion) & 0xFF, PADDLE_W, m.paddleH)) {
+        m.x = side.face;
+        m.y = Math.trunc(f(m.prevY + hitDy));
+        m.dx = -m.dx;
+        side.planned = false;
+        return;
+      }
+    }
+    if((side.face - m.x) * side.dir > 0) {
+      if(!side.planned) {
+        ticks = solveKeepout(m, side);
+        if(side.bouncepos > side.endpos) {
+          top = side.endpos;
+          bottom = (side.bouncepos + BALL_RADIUS) & 0xFF;
+        } else {
+          top = side.bouncepos;
+          bottom = (side.endpos + BALL_RADIUS) & 0xFF;
+        }
+        if(!side.loses) {
+          dest = side.bouncepos + BALL_RADIUS - (m.paddleH >> 1);
+        } else {
+          above = top - m.paddleH - 2;
+          below = bottom + 2;
+          dest = above < m.paddleTop ? below : (below > m.paddleBottom ? above : (m.missAbove ? above : below));
+        }
+        planMotion(m, side, dest, ticks);
+        side.planned = top !== 0;
+      }
+      stepMotion(side.motion);
+    }
+  }
+
+  // Advance the mirrored game to the given frame, the same way the watch does. The serve after a
+  // miss takes a random number only the watch has, so the ball waits at the center for the next
+  // keyframe (which is on its way).
+  function mirrorStateAt(frame) {
+    var m = mirror;
+    if(!m) {
+      return null;
+    }
+    while(m.frame < frame && !m.out) {
+      m.frame++;
+      m.prevX = m.x;
+      m.prevY = m.y;
+      m.x += m.dx;
+      m.y += m.dy;
+      if(m.y > wallBottom(m, m.x)) {
+        m.y = wallBottom(m, m.x);
+        m.dy *= -1;
+      }
+      if(m.y < wallTop(m, m.x)) {
+        m.y = wallTop(m, m.x);
+        m.dy *= -1;
+      }
+      if(m.x > m.width - BALL_RADIUS - 1 || m.x <= BALL_RADIUS) {
+        m.x = m.width >> 1;
+        m.y = m.height >> 1;
+        m.out = true;
+      } else {
+        updatePaddle(m, m.dx > 0 ? m.right : m.left);
+      }
+    }
+    return {
+      frame: m.frame,
+      ball: { x: m.x, y: m.y },
+      leftPaddleY: paddleY(m.left.motion),
+      rightPaddleY: paddleY(m.right.motion)
+    };
+  }
+
+  function frameTime(options) {
+    return options.frameTime || 50;
+  }
+
+  // Watch frame being played back: the last keyframe's, plus the frames since it arrived
+  function currentFrame(options) {
+    return mirrorClock.frame + Math.floor((Date.now() - mirrorClock.time) / frameTime(options));
+  }
+
+  // Send the mirrored match to the companion page, one frame at a time
+  function relayMirror(options) {
+    var state;
+    if(!mirrorClock || mirrorSocket.readyState !== 1) {
+      return;
+    }
+    state = mirrorStateAt(currentFrame(options));
+    if(state) {
+      mirrorSocket.send(JSON.stringify(state));
+    }
+  }
+
+  // (Re)connect to the companion page whenever the settings change
+  function startMirror(options) {
+    if(mirrorTimer) {
+      clearInterval(mirrorTimer);
+      mirrorTimer = null;
+    }
+    if(mirrorSocket) {
+      mirrorSocket.close();
+      mirrorSocket = null;
+    }
+    if(options.mirror && options.mirrorUrl) {
+      mirrorSocket = new window.WebSocket(options.mirrorUrl);
+      mirrorTimer = setInterval(function() {
+        relayMirror(options);
+      }, frameTime(options));
+    }
+  }
+
+  function sendToWatch(options) {
+    var watchOptions = {}, key;
+    for(key in options) {
+      if(PHONE_SETTINGS.indexOf(key) < 0) {
+        watchOptions[key] = options[key];
+      }
+    }
+    Pebble.sendAppMessage(watchOptions);
+    startMirror(options);
+  }
+
   Pebble.addEventListener("ready", function(e) {
     settings = window.localStorage.getItem("pingchrong-settings");
-    if(settings !== "") {
-      var options = JSON.parse(settings);
-      Pebble.sendAppMessage(options);
+    if(settings) {
+      sendToWatch(JSON.parse(settings));
+    }
+  });
+
+  Pebble.addEventListener("appmessage", function(e) {
+    if(e.payload.mirrorKeyframe) {
+      mirror = readKeyframe(e.payload.mirrorKeyframe);
+      mirrorClock = { frame: mirror.frame, time: Date.now() };
     }
   });
 
@@ -14,7 +503,7 @@
     if(!settings) {
       settings = "{}";
     }
-    Pebble.openURL("https://s3.amazonaws.com/pebble.rexmac.com/pingchrong/settings.html?v=2-0-0#" + encodeURIComponent(JSON.stringify(settings)));
+    Pebble.openURL("data:text/html;charset=utf-8," + encodeURIComponent(SETTINGS_PAGE) + "#" + encodeURIComponent(JSON.stringify(settings)));
   });
 
   Pebble.addEventListener("webviewclosed", function(e) {
@@ -22,8 +511,13 @@
         options = (rt === "undefined" ? {} : JSON.parse(decodeURIComponent(e.response)));
     if(Object.keys(options).length > 0) {
       window.localStorage.setItem("pingchrong-settings", JSON.stringify(options));
-      Pebble.sendAppMessage(options);
+      sendToWatch(options);
     }
-  })
-})(Pebble, window);
+  });
 
+  // For the local mock in tools/js, which replays keyframes without a watch
+  window.pingchrongMirror = {
+    readKeyframe: readKeyframe,
+    stateAt: mirrorStateAt
+  };
+})(Pebble, window);
@@ -0,0 +1,95 @@
+#ifndef KEEPOUT_H
+#define KEEPOUT_H
+
+// The keepout solver's core: simulate the ball until it passes a paddle.
+//
+// Shared by calculate_keepout() in pingchrong.c and the host harness's batch
+// solver (tools/host/keepout_batch.c), so that the batch solver runs the very
+// code the watch does. Define before including:
+//   KEEPOUT_WALLS                    type of the walls argument
+//   KEEPOUT_WALL_TOP(walls, x)       highest the ball's center goes, in the simulation, at x
+//   KEEPOUT_WALL_BOTTOM(walls, x)    lowest the ball's center goes at x
+// and optionally KEEPOUT_TRACE_STEP(x, y) and KEEPOUT_TRACE_COLLISION(dir, x, y),
+// run on every step and where the ball meets the paddle's face (for debugging).
+
+#ifndef KEEPOUT_TRACE_STEP
+#define KEEPOUT_TRACE_STEP(x, y)
+#endif
+#ifndef KEEPOUT_TRACE_COLLISION
+#define KEEPOUT_TRACE_COLLISION(dir, x, y)
+#endif
+
+/**
+ * Simulate the ball until it passes a paddle.
+ *
+ * Each wall is looked up once per step, and keepout1 is only written once
+ * the ball has passed, so nothing the loop reads can change under it (which
+ * lets the compiler keep it all in registers).
+ *
+ * @param walls     Passed to KEEPOUT_WALL_TOP() and KEEPOUT_WALL_BOTTOM()
+ * @param left_x    Horizontal position of the left paddle
+ * @param right_x   Horizontal position of the right paddle's outer edge (its position plus its width)
+ * @param radius    Radius of the ball
+ * @param face      Horizontal position of the ball's center when it touches the paddle
+ * @param dir       Sign of the ball's horizontal vector when it is heading towards the paddle
+ * @param x         Horizontal position of ball
+ * @param y         Vertical position of ball
+ * @param dx        Horizontal vector of ball
+ * @param dy        Vertical vector of ball
+ * @param keepout1  Set to the ball's vertical position when it reaches the paddle (left alone if it never does)
+ * @param keepout2  Set to the ball's vertical position when it has passed the paddle
+ * @return uint8_t Number of animation frames until the ball reaches the paddle
+ */
+static inline uint8_t keepout_solve(const KEEPOUT_WALLS *walls, int16_t left_x, int16_t right_x, int16_t radius, int16_t face, int8_t dir,
+    float x, float y, float dx, float dy, uint8_t *keepout1, uint8_t *keepout2) {
+  // converted once here rather than on every step (the same values, so the same answers)
+  const float left = left_x, right = right_x, ball_radius = radius, face_x = face, sign = dir;
+  float bounce_y = 0, wall;
+  uint8_t tix = 0, collided = 0;
+
+  while (((x + ball_radius + 1) < right) && ((x + ball_radius) > left)) {
+    float old_x = x;
+    float old_y = y;
+    y += dy;
+    x += dx;
+    KEEPOUT_TRACE_STEP(x, y);
+
+    // bouncing off bottom wall
+    wall = KEEPOUT_WALL_BOTTOM(walls, x);
+    if (y > wall) {
+      y = wall;
+      dy *= -1;
+    }
+
+    // bouncing off top wall
+    wall = KEEPOUT_WALL_TOP(walls, x);
+    if (y < wall) {
+      y = wall;
+      dy *= -1;
+    }
+
+    if (!collided && ((x - face_x) * sign >= 0)) {
+      // check if we collided with the paddle
+
+      // first determine the exact position at which it would collide
+      float hit_dx = face_x - old_x;
+      // now figure out what fraction that is of the motion and multiply that by the dy
+      float hit_dy = (hit_dx / dx) * dy;
+
+      KEEPOUT_TRACE_COLLISION(dir, old_x + hit_dx, old_y + hit_dy);
+      bounce_y = old_y + hit_dy;
+      collided = 1;
+    }
+    if (!collided) {
+      tix++;
+    }
+  }
+  if (collided) {
+    *keepout1 = bounce_y;
+  }
+  *keepout2 = y;
+
+  return tix;
+}
+
+#endif /* KEEPOUT_H */
@@ -10,49 +10,153 @@
 #include <math.h>
 #include "pingchrong.h"
 
+#ifndef DEBUGGING
 #define DEBUGGING 0
+#endif
+
+#ifdef ANIMATION_FRAME_CLOCK
+#define ANIMATION_FRAME_CLOCK_NAME "animation"
+#else
+#define ANIMATION_FRAME_CLOCK_NAME "timer"
+#endif
 
 // Settings (bit) flags
 enum {
   SETTING_12H_TIME = 1 << 0,
-  SETTING_INVERTED = 1 << 1
+  SETTING_INVERTED = 1 << 1,
+  SETTING_MIRROR = 1 << 2
+};
+
+// Startup stages, run one per frame after the first (static) frame is shown
+enum {
+  STARTUP_SYNC, // start syncing settings with the phone (first, so the inbox is open when the phone sends them)
+  STARTUP_SEED, // seed the PRNG and serve the ball
+  STARTUP_DONE
 };
 
 // Settings AppSync keys; correspond to appKeys in appinfo.json
 enum {
   SETTING_SYNC_KEY_12H_TIME = 0,
-  SETTING_SYNC_KEY_INVERTED = 1
+  SETTING_SYNC_KEY_INVERTED = 1,
+  SETTING_SYNC_KEY_MIRROR = 2,
+  SETTING_SYNC_KEY_BALL_SPEED = 4,
+  SETTING_SYNC_KEY_PADDLE_SIZE = 5,
+  SETTING_SYNC_KEY_PADDLE_SPEED = 6,
+  SETTING_SYNC_KEY_FRAME_TIME = 7
+};
+
+// Keys of messages sent to the JS app; correspond to appKeys in appinfo.json
+enum {
+  MIRROR_KEY_KEYFRAME = 3
+};
+
+// Flags in a keyframe (see mirror_send_keyframe)
+enum {
+  MIRROR_LEFT_LOSES = 1 << 0, // the left paddle is to miss the ball
+  MIRROR_RIGHT_LOSES = 1 << 1, // the right paddle is to miss the ball
+  MIRROR_MISS_ABOVE = 1 << 2, // a losing paddle with room on both sides goes above the ball (crand(2))
+  MIRROR_LEFT_PLANNED = 1 << 3, // the left paddle's move has been planned
+  MIRROR_RIGHT_PLANNED = 1 << 4, // the right paddle's move has been planned
+  MIRROR_ROUND = 1 << 5 // the walls follow the round screen's bezel
 };
 
 static Window *window;
+static uint8_t minute_changed, hour_changed; /**< Booleans used to denote when a unit of time has changed */
 static TextLayer *score_layer; /**< The layer that displays the current score/time */
 static Layer *table_layer; /**< The layer onto which the table is drawn */
 static Layer *anim_layer; /**< The layer onto which the animation is drawn */
+#ifdef ANIMATION_FRAME_CLOCK
+static Animation *frame_clock; /**< Endless animation used to pace animation updates */
+static uint32_t frame_clock_last; /**< Time (in ms) of the previous frame clock update */
+static uint16_t frame_clock_period = ANIMATION_SCHEDULER_PERIOD * 16; /**< Average time between frame clock updates (in 1/16 ms) */
+static uint8_t frame_clock_stride = 1; /**< Frame clock updates per animation update (see update_frame_clock_stride) */
+static uint8_t frame_clock_updates; /**< Frame clock updates since the last animation update */
+#else
 static AppTimer *timer; /**< Time used to schedule animation updates */
+#endif
 static AppSync settings_sync; /**< Keeps settings in sync between phone and watch */
-static uint8_t settings_sync_buffer[32]; /**< Buffer used by settings sync */
+static uint8_t settings_sync_buffer[96]; /**< Buffer used by settings sync */
 static uint8_t settings; /**< Current settings (as bit flags) */
-
-static uint8_t left_paddle_x; /**< Horizontal position of left paddle */
-static uint8_t right_paddle_x; /**< Horizontal position of right paddle */
-static int16_t left_paddle_y; /**< Vertical position of left paddle */
-static int16_t right_paddle_y; /**< Vertical position of right paddle */
-static int16_t left_paddle_prev_y; /**< Vertical position of left paddle in previous animation frame */
-static int16_t right_paddle_prev_y; /**< Vertical position of right paddle in previous animation frame */
-static GSize table_size; /**< Size (in pixels) of table layer */
+static uint8_t ball_speed = 100; /**< Current ball speed, in percent of MAX_BALL_SPEED */
+static uint8_t paddle_h = PADDLE_H; /**< Current paddle size (see PADDLE_H) */
+static uint8_t paddle_speed = PADDLE_SPEED; /**< Current average paddle speed over a move (see PADDLE_SPEED) */
+static uint16_t frame_time = ANIM_FRAME_TIME; /**< Current length of one animation frame (see ANIM_FRAME_TIME) */
+static uint8_t tuning_stale = 1; /**< Boolean used to denote that one of the above changed since the derived values were rebuilt */
+static int16_t paddle_bottom; /**< Bottommost position of a paddle; derived from paddle_h */
+static int8_t serve_dx[SERVE_ANGLES]; /**< Horizontal vector of a serve, for each angle; derived from ball_speed */
+static int8_t serve_dy[SERVE_ANGLES]; /**< Vertical vector of a serve, for each angle; derived from ball_speed */
+
+static PaddleSide left_side = { .dir = -1, .name = 'L', .lose_flag = &minute_changed }; /**< Left paddle; misses when the minute changes */
+static PaddleSide right_side = { .dir = 1, .name = 'R', .lose_flag = &hour_changed }; /**< Right paddle; misses when the hour changes */
 static GPoint ball_pos; /**< Position of ball's center */
 static GPoint ball_prev_pos; /**< Position of ball's center in previous animation frame */
 static float ball_dx; /**< Horizontal vector of ball */
 static float ball_dy; /**< Vertical vector of ball */
-static uint8_t minute_changed, hour_changed; /**< Booleans used to denote when a unit of time has changed */
 static char score[8]; /**< String to hold the current score for display */
 static struct tm *current_time; /**< The current time (updated once a minute) */
 static uint8_t failed; /**< Boolean used for debugging. Indicates AI failure */
+static uint32_t keepout_solves; /**< Number of times the keepout was solved; used for debugging */
+static uint32_t keepout_steps; /**< Number of ball steps simulated while solving the keepout; used for debugging */
+static uint32_t encipher_calls; /**< Number of times the PRNG was stepped; used for debugging */
+static uint32_t frame_count; /**< Number of animation frames drawn so far */
+static uint8_t mirror_due; /**< Boolean used to denote that the phone needs a new keyframe */
+static uint8_t startup_stage; /**< Startup work still to do (see STARTUP_*) */
+static uint32_t startup_ms; /**< Time (in ms) the app started; used for debugging */
+static uint8_t keepout_stale; /**< Boolean used to denote that the table changed size since the keepout was solved */
+static uint8_t frame_due; /**< Boolean used to denote that the frame clock has ticked since the game last moved */
+
+#if defined(TABLE_WIDTH) && !defined(UNOBSTRUCTED_RELAYOUT)
+static const TableGeometry geometry = TABLE_GEOMETRY(TABLE_WIDTH, TABLE_HEIGHT); /**< Table geometry, known at build time (so the compiler folds it into the code) */
+#else
+static TableGeometry geometry; /**< Table geometry, worked out when the window is loaded (and again whenever the screen is partly covered) */
+#endif
+
+#ifdef PBL_ROUND
+static uint8_t round_wall_top[TABLE_WIDTH]; /**< Top wall for each column of a round table */
+static uint8_t round_wall_bottom[TABLE_WIDTH]; /**< Bottom wall for each column of a round table */
+static int16_t round_columns; /**< Number of columns of the above in use (the table width, at most TABLE_WIDTH) */
+static int16_t round_paddle_top; /**< Topmost position of a paddle on a round table */
+static int16_t round_paddle_floor; /**< Lowest position of a paddle's bottom edge on a round table */
+static int16_t round_bar_radius; /**< Outer radius of the top and bottom lines of a round table */
+static int32_t round_bar_angle; /**< Half the angle the top and bottom lines of a round table span, from 12 (or 6) o'clock */
+#define WALL_COLUMN(x) ((x) < 0 ? 0 : ((x) >= round_columns ? round_columns - 1 : (int) (x)))
+#define WALL_TOP(x) round_wall_top[WALL_COLUMN(x)]
+#define WALL_BOTTOM(x) round_wall_bottom[WALL_COLUMN(x)]
+#define SIM_WALL_TOP(x) (round_wall_top[WALL_COLUMN(x)] + 1)
+#define PADDLE_TOP round_paddle_top
+#define PADDLE_FLOOR round_paddle_floor
+#define MIRROR_ROUND_TABLE 1 // the phone works out the round walls from the table size
+#else
+#define WALL_TOP(x) geometry.ball_top
+#define WALL_BOTTOM(x) geometry.ball_bottom
+#define SIM_WALL_TOP(x) geometry.sim_top
+#define PADDLE_TOP geometry.paddle_top
+#define PADDLE_FLOOR geometry.paddle_floor
+#define MIRROR_ROUND_TABLE 0
+#endif
+
+// The keepout solver's core, shared with the host harness's batch solver (see keepout.h)
+#define KEEPOUT_WALLS TableGeometry
+#define KEEPOUT_WALL_TOP(walls, x) SIM_WALL_TOP(x)
+#define KEEPOUT_WALL_BOTTOM(walls, x) WALL_BOTTOM(x)
+#define KEEPOUT_TRACE_STEP(x, y) do { \
+  if (DEBUGGING) {keepout_steps++;} \
+  if (DEBUGGING > 2) {APP_LOG(APP_LOG_LEVEL_DEBUG, "\tSIMball @ [%d,%d]", (int) round(x), (int) round(y));} \
+} while (0)
+#define KEEPOUT_TRACE_COLLISION(dir, x, y) do { \
+  if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "%cCOLL@ (%d, %d)", (dir) < 0 ? 'L' : 'R', (int) round(x), (int) round(y));} \
+} while (0)
+#include "keepout.h"
 
 // Use by the PRNG
 static uint32_t rval[2]={0,0};
 static uint32_t key[4];
 
+// Smoothstep (3t^2 - 2t^3) sampled at PADDLE_EASE_STEPS + 1 points, scaled to 0..256
+static const uint16_t paddle_ease[PADDLE_EASE_STEPS + 1] = {
+  0, 3, 11, 24, 40, 59, 81, 104, 128, 152, 175, 197, 216, 232, 245, 253, 256
+};
+
 /**
  * Wrapper around the cos_lookup function provided by the Pebble SDK.
  *
@@ -98,80 +202,85 @@ static uint8_t intersectrect(uint8_t x1, uint8_t y1, uint8_t w1, uint8_t h1,
   return 1;
 }
 
+#ifdef PBL_ROUND
 /**
- * ???
+ * Integer square root (rounded down).
  *
+ * @param n Non-negative integer
+ * @return int16_t Square root of n
  */
-static uint8_t calculate_keepout(float theball_x, float theball_y, float theball_dx, float theball_dy, uint8_t *keepout1, uint8_t *keepout2) {
-//ticksremaining = calculate_keepout(ball_pos.x, ball_pos.y, ball_dx, ball_dy, &right_bouncepos, &right_endpos);
-
-  // "simulate" the ball bounce...its not optimized (yet)
-  float sim_ball_y = theball_y;
-  float sim_ball_x = theball_x;
-  float sim_ball_dy = theball_dy;
-  float sim_ball_dx = theball_dx;
-
-  uint8_t tix = 0, collided = 0;
-
-  //while ((sim_ball_x < (right_paddle_x + PADDLE_W)) && ((sim_ball_x + BALL_RADIUS) > left_paddle_x)) {
-  while (((sim_ball_x + BALL_RADIUS + 1) < (right_paddle_x + PADDLE_W)) && ((sim_ball_x + BALL_RADIUS) > left_paddle_x)) {
-    float old_sim_ball_x = sim_ball_x;
-    float old_sim_ball_y = sim_ball_y;
-    sim_ball_y += sim_ball_dy;
-    sim_ball_x += sim_ball_dx;
-
-    // bouncing off bottom wall
-    if (sim_ball_y  > (table_size.h - BAR_MARGIN - BAR_HEIGHT - BALL_RADIUS - 1)) {
-      sim_ball_y = table_size.h - BAR_MARGIN - BAR_HEIGHT - BALL_RADIUS - 1;
-      sim_ball_dy *= -1;
-    }
-
-    // bouncing off top wall
-    if (sim_ball_y <  (BAR_MARGIN + BAR_HEIGHT + BALL_RADIUS)) {
-      sim_ball_y = BAR_MARGIN + BAR_HEIGHT + BALL_RADIUS;
-      sim_ball_dy *= -1;
-    }
-
-    if (((sim_ball_x + BALL_RADIUS + 1) >= right_paddle_x) && ((old_sim_ball_x + BALL_RADIUS + 1) < right_paddle_x)) {
-      // check if we collided with the right paddle
-
-      // first determine the exact position at which it would collide
-      float dx = right_paddle_x - (old_sim_ball_x + BALL_RADIUS + 1);
-      // now figure out what fraction that is of the motion and multiply that by the dy
-      float dy = (dx / sim_ball_dx) * sim_ball_dy;
-
-      if (DEBUGGING) {
-        APP_LOG(APP_LOG_LEVEL_DEBUG, "RCOLL@ (%d, %d)", (int) round(old_sim_ball_x + dx), (int) round(old_sim_ball_y + dy));
-      }
-
-      *keepout1 = old_sim_ball_y + dy;
-      collided = 1;
-    } else if ((sim_ball_x <= (left_paddle_x + PADDLE_W)) && (old_sim_ball_x > (left_paddle_x + PADDLE_W))) {
-      // check if we collided with the left paddle
-
-      // first determine the exact position at which it would collide
-      float dx = (left_paddle_x + PADDLE_W) - old_sim_ball_x;
-      // now figure out what fraction that is of the motion and multiply that by the dy
-      float dy = (dx / sim_ball_dx) * sim_ball_dy;
+static int16_t isqrt(int32_t n) {
+  int32_t root = 0;
+  while ((root + 1) * (root + 1) <= n) {
+    root++;
+  }
+  return root;
+}
+#endif
 
-      if (DEBUGGING) {
-        APP_LOG(APP_LOG_LEVEL_DEBUG, "LCOLL@ (%d,%d)", (int) round(old_sim_ball_x + dx), (int) round(old_sim_ball_y + dy));
-      }
+/**
+ * Work out the table geometry.
+ *
+ * Builds for a known screen already have the geometry as constants; this only
+ * fills it in for unknown screens (or screens that may be partially covered),
+ * plus the per-column walls of round tables.
+ *
+ * @param size Size (in pixels) of the table layer
+ */
+static void init_geometry(GSize size) {
+#if defined(TABLE_WIDTH) && !defined(UNOBSTRUCTED_RELAYOUT)
+  if (size.w != geometry.size.w || size.h != geometry.size.h) {
+    APP_LOG(APP_LOG_LEVEL_ERROR, "table is %dx%d, not the %dx%d this build is for", size.w, size.h, geometry.size.w, geometry.size.h);
+  }
+#else
+  geometry = (TableGeometry) TABLE_GEOMETRY(size.w, size.h);
+#endif
+  if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "table_size = %d, %d", geometry.size.w, geometry.size.h);}
+
+#ifdef PBL_ROUND
+  // The bezel acts as the wall, inset by the same amount as the top and bottom lines
+  round_bar_radius = ((size.w < size.h) ? size.w : size.h) / 2 - BAR_MARGIN;
+  const int32_t radius = round_bar_radius - BAR_HEIGHT;
+  const int32_t ball_radius = radius - BALL_RADIUS - 1;
+  int16_t left_face = geometry.left_paddle_x + PADDLE_W + BALL_RADIUS;
+  int16_t right_face = geometry.right_paddle_x - BALL_RADIUS - 1;
+  int16_t x, half;
+  round_columns = (size.w < TABLE_WIDTH) ? size.w : TABLE_WIDTH;
+  for (x = 0; x < round_columns; x++) {
+    // Behind the paddles, the walls stay where they are at the paddle faces, so a missed ball runs straight out
+    int32_t dx = ((x < left_face) ? left_face : ((x > right_face) ? right_face : x)) - geometry.center.x;
+    half = (dx * dx < ball_radius * ball_radius) ? isqrt(ball_radius * ball_radius - dx * dx) : 0;
+    round_wall_top[x] = (geometry.center.y - half > geometry.ball_top) ? geometry.center.y - half : geometry.ball_top;
+    round_wall_bottom[x] = (geometry.center.y + half < geometry.ball_bottom) ? geometry.center.y + half : geometry.ball_bottom;
+  }
 
-      *keepout1 = old_sim_ball_y + dy;
-      collided = 1;
-    }
-    if (!collided) {
-      tix++;
-    }
+  // The top and bottom lines follow the bezel between the paddle faces
+  int32_t bar_dx = (right_face - geometry.center.x < round_bar_radius) ? right_face - geometry.center.x : round_bar_radius;
+  round_bar_angle = atan2_lookup(bar_dx, isqrt(round_bar_radius * round_bar_radius - bar_dx * bar_dx));
 
-    if (DEBUGGING > 2) {
-      APP_LOG(APP_LOG_LEVEL_DEBUG, "\tSIMball @ [%d,%d]", (int) round(sim_ball_x), (int) round(sim_ball_y));
-    }
-  }
-  *keepout2 = sim_ball_y;
+  // Let the paddles reach wherever the ball can reach them (the bezel hides any overhang)
+  int16_t top = (WALL_TOP(left_face) < WALL_TOP(right_face)) ? WALL_TOP(left_face) : WALL_TOP(right_face);
+  int16_t bottom = (WALL_BOTTOM(left_face) > WALL_BOTTOM(right_face)) ? WALL_BOTTOM(left_face) : WALL_BOTTOM(right_face);
+  round_paddle_top = (top - BALL_RADIUS > geometry.paddle_top) ? top - BALL_RADIUS : geometry.paddle_top;
+  round_paddle_floor = (bottom + BALL_RADIUS + 1 < geometry.paddle_floor) ? bottom + BALL_RADIUS + 1 : geometry.paddle_floor;
+#endif
+}
 
-  return tix;
+/**
+ * Simulate the ball until it passes a paddle.
+ *
+ * @param side        The paddle the ball is heading towards
+ * @param theball_x   Horizontal position of ball
+ * @param theball_y   Vertical position of ball
+ * @param theball_dx  Horizontal vector of ball
+ * @param theball_dy  Vertical vector of ball
+ * @param keepout1    Set to the ball's vertical position when it reaches the paddle
+ * @param keepout2    Set to the ball's vertical position when it has passed the paddle
+ * @return uint8_t Number of animation frames until the ball reaches the paddle
+ */
+static uint8_t calculate_keepout(const PaddleSide *side, float theball_x, float theball_y, float theball_dx, float theball_dy, uint8_t *keepout1, uint8_t *keepout2) {
+  return keepout_solve(&geometry, geometry.left_paddle_x, geometry.right_paddle_x + PADDLE_W, BALL_RADIUS, side->face, side->dir,
+    theball_x, theball_y, theball_dx, theball_dy, keepout1, keepout2);
 }
 
 /**
@@ -181,6 +290,7 @@ static uint8_t calculate_keepout(float theball_x, float theball_y, float theball
 static void encipher(void) {  // Using 32 rounds of XTea encryption as a PRNG.
   unsigned int i;
   uint32_t v0=rval[0], v1=rval[1], sum=0, delta=0x9E3779B9;
+  if (DEBUGGING) {encipher_calls++;}
   for (i=0; i < 32; i++) {
     v0 += (((v1 << 4) ^ (v1 >> 5)) + v1) ^ (sum + key[sum & 3]);
     sum += delta;
@@ -258,29 +368,57 @@ static uint16_t crand(uint8_t type) {
 }
 
 /**
- * ???
+ * Serve the ball from the center of the table in a random direction.
  *
  */
-static float random_angle_rads(void) {
-  // Create random vector MEME seed it ok???
-  float angle = crand(0);
-
-  // angle = 31930; // MEME DEBUG
-  if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "rand = %d", (int)angle);}
-  //angle = (angle * (90.0 - MIN_BALL_ANGLE*2)  / RAND_MAX) + MIN_BALL_ANGLE;
-  angle = (angle * (90.0 - MIN_BALL_ANGLE*2)  / TRIG_MAX_ANGLE) + MIN_BALL_ANGLE;
+static void serve_ball(void) {
+  // Pick an angle between MIN_BALL_ANGLE and 90 - MIN_BALL_ANGLE degrees
+  uint16_t rand = crand(0);
+  uint8_t angle = ((uint32_t) rand * SERVE_ANGLES) >> 16;
+  if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "rand = %d", rand);}
 
   // Pick the quadrant
   uint8_t quadrant = (crand(1)) % 4;
-  //quadrant = 2; // MEME DEBUG
-
   if (DEBUGGING) { APP_LOG(APP_LOG_LEVEL_DEBUG, "quad = %d", quadrant); }
-  angle += quadrant * 90;
-  if (DEBUGGING) { APP_LOG(APP_LOG_LEVEL_DEBUG, "new ejection angle = %d", (int) angle); }
+  if (DEBUGGING) { APP_LOG(APP_LOG_LEVEL_DEBUG, "new ejection angle = %d", angle + MIN_BALL_ANGLE + quadrant * 90); }
+
+  // Rotate the first-quadrant vector by 90 degrees per quadrant
+  int8_t dx = serve_dx[angle], dy = serve_dy[angle], t;
+  for (; quadrant > 0; quadrant--) {
+    t = dx;
+    dx = -dy;
+    dy = t;
+  }
 
-  angle *= 3.1416;
-  angle /= 180;
-  return angle;
+  ball_pos = geometry.center;
+  ball_dx = dx;
+  ball_dy = dy;
+}
+
+/**
+ * Rebuild everything derived from the tunable game parameters.
+ *
+ * Only called (at the start of a frame) after a parameter has changed.
+ */
+static void rebuild_tuning(void) {
+  uint8_t i;
+
+  paddle_bottom = PADDLE_FLOOR - paddle_h;
+
+  for (i = 0; i < SERVE_ANGLES; i++) {
+    float angle = (i + MIN_BALL_ANGLE) * 3.1416 / 180;
+    serve_dx[i] = (MAX_BALL_SPEED * safe_cos(angle) * ball_speed + 50) / 100;
+    serve_dy[i] = (MAX_BALL_SPEED * safe_sin(angle) * ball_speed + 50) / 100;
+  }
+
+  // Keep the paddles on the table and plan their moves again
+  if (left_side.y > paddle_bottom) place_paddle(&left_side, paddle_bottom);
+  if (right_side.y > paddle_bottom) place_paddle(&right_side, paddle_bottom);
+  keepout_stale = 1;
+  mirror_due = 1;
+
+  tuning_stale = 0;
+  if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "tuning: ball %d%%, paddle %d @ %d, frame %d ms", ball_speed, paddle_h, paddle_speed, frame_time);}
 }
 
 /**
@@ -303,6 +441,256 @@ static void set_score(void) {
   //layer_mark_dirty(score_layer);
 }
 
+/**
+ * Plan a paddle move from one position to another.
+ *
+ * The move is spread over all but the last of the remaining ticks and follows
+ * the easing table, so the paddle accelerates away and settles into place
+ * instead of jumping at the last moment.
+ *
+ * @param motion Paddle motion profile to fill in
+ * @param from_y Current vertical position of the paddle
+ * @param to_y   Desired vertical position of the paddle
+ * @param ticks  Number of animation frames until the ball reaches the paddle
+ */
+static void plan_paddle_motion(PaddleMotion *motion, int16_t from_y, int16_t to_y, uint8_t ticks) {
+  const uint16_t phase_end = PADDLE_EASE_STEPS << 8;
+  uint8_t duration = ticks > 2 ? ticks - 1 : 1;
+
+  // make sure the paddle never leaves the table
+  if (to_y < PADDLE_TOP)
+    to_y = PADDLE_TOP;
+  if (to_y > paddle_bottom)
+    to_y = paddle_bottom;
+
+  // never plan a move faster on average than the paddle speed (smoothstep peaks at 1.5x that)
+  uint8_t min_duration = (abs(to_y - from_y) + paddle_speed - 1) / paddle_speed;
+  if (duration < min_duration)
+    duration = min_duration;
+
+  motion->start_y = from_y;
+  motion->delta_y = to_y - from_y;
+  motion->phase = 0;
+  motion->phase_step = (phase_end + duration - 1) / duration;
+
+  if (DEBUGGING > 1) {
+    APP_LOG(APP_LOG_LEVEL_DEBUG, "\tpaddle %d -> %d over %d tix", from_y, to_y, duration);
+  }
+}
+
+/**
+ * Advance a paddle move by one animation frame.
+ *
+ * @param motion Paddle motion profile
+ * @return int16_t New vertical position of the paddle
+ */
+static int16_t step_paddle_motion(PaddleMotion *motion) {
+  const uint16_t phase_end = PADDLE_EASE_STEPS << 8;
+
+  if (motion->phase < phase_end) {
+    motion->phase += motion->phase_step;
+    if (motion->phase > phase_end)
+      motion->phase = phase_end;
+  }
+
+  uint8_t i = motion->phase >> 8;
+  int32_t ease = paddle_ease[i];
+  if (i < PADDLE_EASE_STEPS) {
+    // linear interpolation between the two nearest table entries
+    ease += ((paddle_ease[i + 1] - paddle_ease[i]) * (motion->phase & 0xFF)) >> 8;
+  }
+
+  return motion->start_y + (motion->delta_y * ease) / 256;
+}
+
+/**
+ * Put a paddle somewhere outside of a planned move.
+ *
+ * The paddle's motion is replaced with one that has already finished where
+ * the paddle now is, so stepping it (here or on the phone) leaves the paddle
+ * in place until the next move is planned.
+ *
+ * @param side The paddle to move
+ * @param y    New vertical position of the paddle
+ */
+static void place_paddle(PaddleSide *side, int16_t y) {
+  side->y = y;
+  side->motion.start_y = y;
+  side->motion.delta_y = 0;
+  side->motion.phase = PADDLE_EASE_STEPS << 8;
+  side->motion.phase_step = 0;
+  mirror_due = 1;
+}
+
+/**
+ * Write a paddle motion profile into a keyframe.
+ *
+ * @param data   Where to write the profile (8 bytes)
+ * @param motion Paddle motion profile
+ */
+static void mirror_pack_motion(uint8_t *data, const PaddleMotion *motion) {
+  data[0] = motion->start_y & 0xFF;
+  data[1] = (motion->start_y >> 8) & 0xFF;
+  data[2] = motion->delta_y & 0xFF;
+  data[3] = (motion->delta_y >> 8) & 0xFF;
+  data[4] = motion->phase & 0xFF;
+  data[5] = (motion->phase >> 8) & 0xFF;
+  data[6] = motion->phase_step & 0xFF;
+  data[7] = (motion->phase_step >> 8) & 0xFF;
+}
+
+/**
+ * Send the current game state to the JS app so it can mirror the match.
+ *
+ * The phone runs the same game step (the paddle AI included), so from one
+ * keyframe it rebuilds every frame up to the next miss. Keyframes are only
+ * needed for what it cannot work out itself: a serve (which takes a random
+ * number), a paddle told to lose the point, a change of settings or of table
+ * size, and turning mirroring on. If the outbox is busy, the keyframe is
+ * retried on the next frame.
+ */
+static void mirror_send_keyframe(void) {
+  uint8_t data[MIRROR_KEYFRAME_SIZE];
+  DictionaryIterator *iter;
+
+  data[0] = frame_count & 0xFF;
+  data[1] = (frame_count >> 8) & 0xFF;
+  data[2] = (frame_count >> 16) & 0xFF;
+  data[3] = (frame_count >> 24) & 0xFF;
+  data[4] = ball_pos.x & 0xFF;
+  data[5] = (ball_pos.x >> 8) & 0xFF;
+  data[6] = ball_pos.y & 0xFF;
+  data[7] = (ball_pos.y >> 8) & 0xFF;
+  data[8] = (int8_t) ball_dx;
+  data[9] = (int8_t) ball_dy;
+  data[10] = (minute_changed ? MIRROR_LEFT_LOSES : 0) | (hour_changed ? MIRROR_RIGHT_LOSES : 0) |
+    ((crand(2) & 0x1) ? MIRROR_MISS_ABOVE : 0) | (left_side.keepout_top ? MIRROR_LEFT_PLANNED : 0) |
+    (right_side.keepout_top ? MIRROR_RIGHT_PLANNED : 0) | (MIRROR_ROUND_TABLE ? MIRROR_ROUND : 0);
+  data[11] = geometry.size.w;
+  data[12] = geometry.size.h;
+  data[13] = geometry.ball_top;
+  data[14] = geometry.ball_bottom;
+  data[15] = geometry.left_paddle_x;
+  data[16] = geometry.right_paddle_x;
+  data[17] = PADDLE_TOP;
+  data[18] = paddle_bottom;
+  data[19] = paddle_h;
+  data[20] = paddle_speed;
+  mirror_pack_motion(&data[21], &left_side.motion);
+  mirror_pack_motion(&data[29], &right_side.motion);
+
+  if (app_message_outbox_begin(&iter) != APP_MSG_OK) {
+    if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "mirror outbox busy");}
+    return;
+  }
+  dict_write_data(iter, MIRROR_KEY_KEYFRAME, data, sizeof(data));
+  app_message_outbox_send();
+  mirror_due = 0;
+}
+
+/**
+ * Move one paddle: bounce the ball off it, or work out where it should go.
+ *
+ * @param side The paddle the ball is heading towards
+ * @param ctx  The destination graphics context (for debugging)
+ */
+static void update_paddle(PaddleSide *side, GContext *ctx) {
+  // Check if we are bouncing off the paddle
+  if (((ball_pos.x - side->face) * side->dir >= 0) && ((ball_prev_pos.x - side->face) * side->dir <= 0)) {
+    // check if we collided
+    if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "coll?");}
+    // determine the exact position at which it would collide
+    float dx = side->face - ball_prev_pos.x;
+    // now figure out what fraction that is of the motion and multiply that by the dy
+    float dy = (dx / ball_dx) * ball_dy;
+
+    // the ball covers 2 * BALL_RADIUS + 1 pixels around its center
+    if (intersectrect((side->face - BALL_RADIUS), (ball_prev_pos.y + dy - BALL_RADIUS), BALL_RADIUS*2 + 1, BALL_RADIUS*2 + 1,
+                      side->x, side->y, PADDLE_W, paddle_h)) {
+      if (DEBUGGING) {
+        APP_LOG(APP_LOG_LEVEL_DEBUG, "nosect");
+        if (*side->lose_flag) {
+          APP_LOG(APP_LOG_LEVEL_DEBUG, "FAILED to miss");
+          if (side->ticks > 1) failed = 1;
+        }
+        APP_LOG(APP_LOG_LEVEL_DEBUG, "%cCOLLISION ball @ (%d, %d) & paddle @ (%d, %d)", side->name,
+          (int) round(ball_prev_pos.x + dx), (int) round(ball_prev_pos.y + dy), side->x, side->y);
+      }
+
+      // set the ball right up against the paddle
+      ball_pos.x = side->face;
+      ball_pos.y = ball_prev_pos.y + dy;
+      // bounce it
+      ball_dx *= -1;
+
+      side->bouncepos = side->keepout_top = side->keepout_bot = 0;
+      return;
+    }
+    // otherwise, it didn't bounce...will probably hit the wall behind the paddle
+    if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, " tix = %d", side->ticks);}
+  }
+
+  if ((side->face - ball_pos.x) * side->dir > 0) {
+    // ball is coming towards the paddle
+
+    if (side->keepout_top == 0) {
+      side->ticks = calculate_keepout(side, ball_pos.x, ball_pos.y, ball_dx, ball_dy, &side->bouncepos, &side->endpos);
+      if (DEBUGGING) {
+        keepout_solves++;
+        APP_LOG(APP_LOG_LEVEL_DEBUG, "Expect bounce @ %d -> %d in %d tix", side->bouncepos, side->endpos, side->ticks);
+      }
+      if (side->bouncepos > side->endpos) {
+        side->keepout_top = side->endpos;
+        side->keepout_bot = side->bouncepos + BALL_RADIUS;
+      } else {
+        side->keepout_top = side->bouncepos;
+        side->keepout_bot = side->endpos + BALL_RADIUS;
+      }
+      if (DEBUGGING) {
+        APP_LOG(APP_LOG_LEVEL_DEBUG, "Keepout from %d to %d", side->keepout_top, side->keepout_bot);
+      }
+
+      // Now we can calculate where the paddle should go
+      int16_t dest;
+      if (!*side->lose_flag) {
+        // we want to hit the ball, so make it centered
+        dest = side->bouncepos + BALL_RADIUS - (paddle_h / 2);
+        if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "hit%c -> %d", side->name, dest);}
+      } else {
+        // we lost the round so make sure we -dont- hit the ball
+        int16_t above = side->keepout_top - paddle_h - 2;
+        int16_t below = side->keepout_bot + 2;
+        if (above < PADDLE_TOP) {
+          // the ball is near the top so make sure it ends up right below it
+          if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "at the top");}
+          dest = below;
+        } else if (below > paddle_bottom) {
+          // the ball is near the bottom so make sure it ends up right above it
+          if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "at the bottom");}
+          dest = above;
+        } else {
+          if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "in the middle");}
+          if (((uint8_t)crand(2)) & 0x1)
+            dest = above;
+          else
+            dest = below;
+        }
+        if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "miss%c -> %d", side->name, dest);}
+      }
+      plan_paddle_motion(&side->motion, side->y, dest, side->ticks);
+    } else {
+      side->ticks--;
+    }
+
+    // draw the keepout area (for debugging)
+    if (DEBUGGING) {
+      graphics_draw_rect(ctx, GRect(side->x, side->keepout_top, PADDLE_W, side->keepout_bot - side->keepout_top));
+    }
+
+    side->y = step_paddle_motion(&side->motion);
+  }
+}
+
 /**
  * Draw the animation.
  *
@@ -313,42 +701,57 @@ static void anim_layer_update_callback(Layer * const me, GContext * ctx) {
   graphics_context_set_fill_color(ctx, (settings & SETTING_INVERTED) > 0 ? GColorBlack : GColorWhite);
   graphics_context_set_stroke_color(ctx, (settings & SETTING_INVERTED) > 0 ? GColorBlack : GColorWhite);
 
-  if (failed) {
+  // Only the frame clock moves the game on; other redraws (a relayout, a new score) show it as it is
+  const uint8_t step = frame_due;
+  frame_due = 0;
+
+  if (DEBUGGING && step) {
+    record_frame_jitter();
+  }
+
+  if (DEBUGGING && startup_stage == STARTUP_SYNC) {
+    APP_LOG(APP_LOG_LEVEL_DEBUG, "first frame after %d ms", (int) (now_ms() - startup_ms));
+  }
+
+  if (failed || startup_stage != STARTUP_DONE || !step) {
     // Draw the ball
     graphics_fill_circle(ctx, ball_pos, BALL_RADIUS);
     // Draw the paddles
-    graphics_fill_rect(ctx, GRect(left_paddle_x, left_paddle_y, PADDLE_W, PADDLE_H), 1, GCornersAll);
-    graphics_fill_rect(ctx, GRect(right_paddle_x, right_paddle_y, PADDLE_W, PADDLE_H), 1, GCornersAll);
+    graphics_fill_rect(ctx, GRect(left_side.x, left_side.y, PADDLE_W, paddle_h), 1, GCornersAll);
+    graphics_fill_rect(ctx, GRect(right_side.x, right_side.y, PADDLE_W, paddle_h), 1, GCornersAll);
     return;
   }
-  GRect bounds = layer_get_bounds(me);
-  //ball_pos = GPoint(bounds.size.w / 2, bounds.size.h / 2);
+  frame_count++;
 
   // Save old ball location so we can do some vector stuff 
   ball_prev_pos = GPoint(ball_pos.x, ball_pos.y);
 
-  // The keepout is used to know where to -not- put the paddle
-  // the 'bouncepos' is where we expect the ball's y-coord to be when
-  // it intersects with the paddle area
-  static uint8_t right_keepout_top, right_keepout_bot, right_bouncepos, right_endpos;
-  static uint8_t left_keepout_top, left_keepout_bot, left_bouncepos, left_endpos;
-  static int16_t right_dest, left_dest;
-  static uint8_t ticksremaining;
+  // A setting changed, so rebuild what depends on it
+  if (tuning_stale) {
+    rebuild_tuning();
+  }
+
+  // The table changed size, so solve the keepout again with the new walls
+  if (keepout_stale) {
+    left_side.keepout_top = left_side.keepout_bot = 0;
+    right_side.keepout_top = right_side.keepout_bot = 0;
+    keepout_stale = 0;
+  }
 
   // Move the ball according to the vector
   ball_pos.x += ball_dx;
   ball_pos.y += ball_dy;
 
   // bouncing off bottom wall, reverse direction
-  if (ball_pos.y  > (table_size.h - BAR_MARGIN - BAR_HEIGHT - BALL_RADIUS - 1)) {
+  if (ball_pos.y  > WALL_BOTTOM(ball_pos.x)) {
     if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "Bottom wall bounce");}
-    ball_pos.y = table_size.h - BAR_MARGIN - BAR_HEIGHT - BALL_RADIUS - 1;
+    ball_pos.y = WALL_BOTTOM(ball_pos.x);
     ball_dy *= -1;
   }
   // bouncing off top wall, reverse direction
-  if (ball_pos.y  < (BAR_MARGIN + BAR_HEIGHT + BALL_RADIUS - 1)) {
+  if (ball_pos.y  < WALL_TOP(ball_pos.x)) {
     if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "Top wall bounce");}
-    ball_pos.y = BAR_MARGIN + BAR_HEIGHT + BALL_RADIUS - 1;
+    ball_pos.y = WALL_TOP(ball_pos.x);
     ball_dy *= -1;
   }
 
@@ -358,7 +761,7 @@ static void anim_layer_update_callback(Layer * const me, GContext * ctx) {
   }
 
   // If the ball hits the left or right wall, then the reset the ball and paddles
-  if ((ball_pos.x  > (table_size.w - BALL_RADIUS - 1)) || (ball_pos.x <= BALL_RADIUS)) {
+  if ((ball_pos.x  > geometry.ball_right) || (ball_pos.x <= BALL_RADIUS)) {
     if (DEBUGGING) {
       if (ball_pos.x <= BALL_RADIUS) {
         APP_LOG(APP_LOG_LEVEL_DEBUG, "Left wall collide");
@@ -382,299 +785,38 @@ static void anim_layer_update_callback(Layer * const me, GContext * ctx) {
     }
 
     // Reset ball position (center of screen)
-    ball_pos = GPoint(bounds.size.w / 2, bounds.size.h / 2);
-    float angle = random_angle_rads();
-    ball_dx = MAX_BALL_SPEED * safe_cos(angle);
-    ball_dy = MAX_BALL_SPEED * safe_sin(angle);
+    serve_ball();
 
     // Reset paddle positions
-    graphics_fill_rect(ctx, GRect(2, left_paddle_y, PADDLE_W, PADDLE_H), 1, GCornersAll); // left paddle
-    graphics_fill_rect(ctx, GRect(bounds.size.w - PADDLE_W - 2, right_paddle_y, PADDLE_W, PADDLE_H), 1, GCornersAll); // right paddle
+    graphics_fill_rect(ctx, GRect(left_side.x, left_side.y, PADDLE_W, paddle_h), 1, GCornersAll); // left paddle
+    graphics_fill_rect(ctx, GRect(right_side.x, right_side.y, PADDLE_W, paddle_h), 1, GCornersAll); // right paddle
 
     // Reset scoring variables
-    right_keepout_top = right_keepout_bot = 0;
-    left_keepout_top = left_keepout_bot = 0;
+    left_side.keepout_top = left_side.keepout_bot = 0;
+    right_side.keepout_top = right_side.keepout_bot = 0;
     minute_changed = hour_changed = 0;
     set_score();
+    mirror_due = 1;
   }
 
   // Save the old paddle positions
-  left_paddle_prev_y = left_paddle_y;
-  right_paddle_prev_y = right_paddle_y;
-
-  // Check if we are bouncing off right paddle
-  if (ball_dx > 0) {
-    if (((ball_pos.x + BALL_RADIUS + 1) >= right_paddle_x) && ((ball_prev_pos.x + BALL_RADIUS + 1) <= right_paddle_x)) {
-      // check if we collided
-      if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "coll?");}
-      // determine the exact position at which it would collide
-      float dx = right_paddle_x - (ball_prev_pos.x + BALL_RADIUS + 1);
-      // now figure out what fraction that is of the motion and multiply that by the dy
-      float dy = (dx / ball_dx) * ball_dy;
-
-      if (intersectrect((ball_pos.x + dx - BALL_RADIUS + 1), (ball_prev_pos.y + dy - BALL_RADIUS + 1), BALL_RADIUS*2, BALL_RADIUS*2,
-                      right_paddle_x, right_paddle_y, PADDLE_W, PADDLE_H)) {
-        if (DEBUGGING) {
-          APP_LOG(APP_LOG_LEVEL_DEBUG, "nosect");
-          if (hour_changed) {
-            APP_LOG(APP_LOG_LEVEL_DEBUG, "FAILED to miss");
-            if (ticksremaining > 1) failed = 1;
-          }
-
-          APP_LOG(APP_LOG_LEVEL_DEBUG, "RCOLLISION  ball @ (%d, %d) & paddle @ (%d, %d)",
-            (int) round(ball_prev_pos.x + dx), (int) round(ball_prev_pos.y + dy),
-            right_paddle_x, right_paddle_y
-          );
-        }
+  left_side.prev_y = left_side.y;
+  right_side.prev_y = right_side.y;
 
-        // set the ball right up against the paddle
-        ball_pos.x = ball_prev_pos.x + dx;
-        ball_pos.y = ball_prev_pos.y + dy;
-        // bounce it
-        ball_dx *= -1;
-
-        right_bouncepos = right_dest = right_keepout_top = right_keepout_bot = 0;
-        left_bouncepos = left_dest = left_keepout_top = left_keepout_bot = 0;
-      }
-      // otherwise, it didn't bounce...will probably hit the right wall
-      if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, " tix = %d", ticksremaining);}
-    }
-
-    if ((ball_dx > 0) && ((ball_pos.x + BALL_RADIUS + 1) < right_paddle_x)) {
-      // ball is coming towards the right paddle
-
-      if (right_keepout_top == 0) {
-        ticksremaining = calculate_keepout(ball_pos.x, ball_pos.y, ball_dx, ball_dy, &right_bouncepos, &right_endpos);
-        if (DEBUGGING) {
-          APP_LOG(APP_LOG_LEVEL_DEBUG, "Expect bounce @ %d -> %d in %d tix", right_bouncepos, right_endpos, ticksremaining);
-        }
-        if (right_bouncepos > right_endpos) {
-          right_keepout_top = right_endpos;
-          right_keepout_bot = right_bouncepos + BALL_RADIUS - 1;
-        } else {
-          right_keepout_top = right_bouncepos;
-          right_keepout_bot = right_endpos + BALL_RADIUS - 1;
-        }
-        if (DEBUGGING) {
-          APP_LOG(APP_LOG_LEVEL_DEBUG, "Keepout from %d to %d" , right_keepout_top, right_keepout_bot);
-        }
+  // Only the paddle the ball is heading towards has anything to do
+  update_paddle(ball_dx > 0 ? &right_side : &left_side, ctx);
 
-        // Now we can calculate where the paddle should go
-        if (!hour_changed) {
-          // we want to hit the ball, so make it centered
-          right_dest = right_bouncepos + BALL_RADIUS - (PADDLE_H/2);
-          if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "hitR -> %d", right_dest);}
-        } else {
-          // we lost the round so make sure we -dont- hit the ball
-          if (right_keepout_top <= (BAR_MARGIN + BAR_HEIGHT + PADDLE_H)) {
-            // the ball is near the top so make sure it ends up right below it
-            if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "at the top");}
-            right_dest = right_keepout_bot + 2;
-          } else if (right_keepout_bot >= (table_size.h - BAR_MARGIN - BAR_HEIGHT - PADDLE_H - 2)) {
-            // the ball is near the bottom so make sure it ends up right above it
-            if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "at the bottom");}
-            right_dest = right_keepout_top - PADDLE_H - 2;
-          } else {
-            if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "in the middle");}
-            if ( ((uint8_t)crand(2)) & 0x1)
-              right_dest = right_keepout_top - PADDLE_H - 2;
-            else
-              right_dest = right_keepout_bot + 2;
-          }
-          if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "missR -> %d", right_dest); }
-        }
-      } else {
-        ticksremaining--;
-      }
-
-      // draw the keepout area (for debugging)
-      if (DEBUGGING) {
-        graphics_draw_rect(ctx, GRect(right_paddle_x, right_keepout_top, PADDLE_W, right_keepout_bot - right_keepout_top));
-      }
-
-      int16_t distance = right_paddle_y - right_dest;
-
-      if (DEBUGGING > 1) {
-        APP_LOG(APP_LOG_LEVEL_DEBUG, "\tdest dist: %d", abs(distance));
-        APP_LOG(APP_LOG_LEVEL_DEBUG, "\ttix: %d", ticksremaining);
-        APP_LOG(APP_LOG_LEVEL_DEBUG, "\tmax travel: %d", ticksremaining * MAX_PADDLE_SPEED);
-        APP_LOG(APP_LOG_LEVEL_DEBUG, "\tright paddle @ %d\n", right_paddle_y);
-      }
-
-      // if we have just enough time, move the paddle!
-      if (abs(distance) > (ticksremaining-1) * MAX_PADDLE_SPEED) {
-        if (DEBUGGING > 1) {
-          APP_LOG(APP_LOG_LEVEL_DEBUG, "Right paddle should begin moving now!");
-        }
-        distance = abs(distance);
-        if (right_dest > right_paddle_y ) {
-          if (DEBUGGING > 1) {
-            APP_LOG(APP_LOG_LEVEL_DEBUG, "Right paddle should begin moving down!");
-          }
-          if (distance > MAX_PADDLE_SPEED)
-            right_paddle_y += MAX_PADDLE_SPEED;
-          else
-            right_paddle_y += distance;
-        }
-        if (right_dest < right_paddle_y) {
-          if (DEBUGGING > 1) {
-            APP_LOG(APP_LOG_LEVEL_DEBUG, "Right paddle should begin moving up!");
-          }
-          if (distance > MAX_PADDLE_SPEED)
-            right_paddle_y -= MAX_PADDLE_SPEED;
-          else
-            right_paddle_y -= distance;
-        }
-      }
-    }
-  } else {
-    // check if we are bouncing off left paddle
-    if ((ball_pos.x <= (left_paddle_x + PADDLE_W + BALL_RADIUS)) && (ball_prev_pos.x >= (left_paddle_x + PADDLE_W + BALL_RADIUS))) {
-      // check if we collided
-      if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "coll?");}
-      // determine the exact position at which it would collide
-      float dx = (left_paddle_x + PADDLE_W + BALL_RADIUS) - ball_prev_pos.x;
-      // now figure out what fraction that is of the motion and multiply that by the dy
-      float dy = (dx / ball_dx) * ball_dy;
-
-      if (intersectrect((ball_prev_pos.x + dx - BALL_RADIUS), (ball_prev_pos.y + dy - BALL_RADIUS), BALL_RADIUS*2, BALL_RADIUS*2,
-                      left_paddle_x, left_paddle_y, PADDLE_W, PADDLE_H)) {
-        if (DEBUGGING) {
-          APP_LOG(APP_LOG_LEVEL_DEBUG, "nosect");
-          if (minute_changed) {
-            APP_LOG(APP_LOG_LEVEL_DEBUG, "FAILED to miss");
-            if (ticksremaining > 1) failed = 1;
-          }
-          APP_LOG(APP_LOG_LEVEL_DEBUG, "LCOLLISION ball @ (%d, %d) & paddle @ (%d, %d)",
-            (int) round(ball_prev_pos.x + dx), (int) round(ball_prev_pos.y + dy), left_paddle_x, left_paddle_y);
-        }
-
-        // bounce it
-        ball_dx *= -1;
-
-        if (ball_pos.x != left_paddle_x + PADDLE_W + BALL_RADIUS) {
-          // set the ball right up against the paddle
-          ball_pos.x = ball_prev_pos.x + dx;
-          ball_pos.y = ball_prev_pos.y + dy;
-        }
-        left_bouncepos = left_dest = left_keepout_top = left_keepout_bot = 0;
-      }
-      // otherwise, it didn't bounce...will probably hit the left wall
-      if (DEBUGGING) { APP_LOG(APP_LOG_LEVEL_DEBUG, " tix = %d", ticksremaining); }
-    }
-
-    if ((ball_dx < 0) && (ball_pos.x > (left_paddle_x + BALL_RADIUS))) {
-      // ball is coming towards the left paddle
-
-      if (left_keepout_top == 0 ) {
-        ticksremaining = calculate_keepout(ball_pos.x, ball_pos.y, ball_dx, ball_dy, &left_bouncepos, &left_endpos);
-        if (DEBUGGING) {
-          APP_LOG(APP_LOG_LEVEL_DEBUG, "Expect bounce @ %d -> %d in %d tix", left_bouncepos, left_endpos, ticksremaining);
-        }
-
-        if (left_bouncepos > left_endpos) {
-          left_keepout_top = left_endpos;
-          left_keepout_bot = left_bouncepos + BALL_RADIUS;
-        } else {
-          left_keepout_top = left_bouncepos;
-          left_keepout_bot = left_endpos + BALL_RADIUS;
-        }
-        if (DEBUGGING) {
-          APP_LOG(APP_LOG_LEVEL_DEBUG, "Keepout from %d to %d", left_keepout_top, left_keepout_bot);
-        }
-
-        // Now we can calculate where the paddle should go
-        if (!minute_changed) {
-          // we want to hit the ball, so make it centered
-          left_dest = left_bouncepos + BALL_RADIUS - (PADDLE_H / 2);
-          if (DEBUGGING) {
-            APP_LOG(APP_LOG_LEVEL_DEBUG, "hitL -> %d", left_dest);
-          }
-        } else {
-          // we lost the round so make sure we -dont- hit the ball
-          if (left_keepout_top <= (BAR_MARGIN + BAR_HEIGHT + PADDLE_H)) {
-            // the ball is near the top so make sure it ends up right below it
-            if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "at the top");}
-            left_dest = left_keepout_bot + 2;
-          } else if (left_keepout_bot >= (table_size.h - BAR_MARGIN - BAR_HEIGHT - PADDLE_H - 2)) {
-            // the ball is near the bottom so make sure it ends up right above it
-            if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "at the bottom");}
-            left_dest = left_keepout_top - PADDLE_H - 2;
-          } else {
-            if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "in the middle");}
-            if (((uint8_t)crand(2)) & 0x1)
-              left_dest = left_keepout_top - PADDLE_H - 2;
-            else
-              left_dest = left_keepout_bot + 2;
-          }
-          if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "missL -> %d", left_dest);}
-        }
-      } else {
-        ticksremaining--;
-      }
-      // draw the keepout area (for debugging)
-      if (DEBUGGING) {
-        graphics_draw_rect(ctx, GRect(left_paddle_x, left_keepout_top, PADDLE_W, left_keepout_bot - left_keepout_top));
-      }
-
-      int16_t distance = abs(left_paddle_y - left_dest);
-
-      if (DEBUGGING > 1) {
-        APP_LOG(APP_LOG_LEVEL_DEBUG, "\tdest dist: %d", abs(distance));
-        APP_LOG(APP_LOG_LEVEL_DEBUG, "\ttix: %d", ticksremaining);
-        APP_LOG(APP_LOG_LEVEL_DEBUG, "\tmax travel: %d", ticksremaining * MAX_PADDLE_SPEED);
-        APP_LOG(APP_LOG_LEVEL_DEBUG, "\tleft paddle @ %d", left_paddle_y);
-        APP_LOG(APP_LOG_LEVEL_DEBUG, "\thitL -> %d\n", left_dest);
-      }
-
-      // if we have just enough time, move the paddle!
-      if (abs(distance) > ((ticksremaining - 1) * MAX_PADDLE_SPEED)) {
-        if (DEBUGGING > 1) {
-          APP_LOG(APP_LOG_LEVEL_DEBUG, "Left paddle should begin moving now!");
-        }
-        distance = abs(distance);
-        if (left_dest > left_paddle_y) {
-          if (DEBUGGING > 1) {
-            APP_LOG(APP_LOG_LEVEL_DEBUG, "Left paddle should begin moving down!");
-          }
-          if (distance > MAX_PADDLE_SPEED)
-            left_paddle_y += MAX_PADDLE_SPEED;
-          else
-            left_paddle_y += distance;
-        }
-        if (left_dest < left_paddle_y) {
-          if (DEBUGGING > 1) {
-            APP_LOG(APP_LOG_LEVEL_DEBUG, "Left paddle should begin moving up!");
-          }
-          if (distance > MAX_PADDLE_SPEED)
-            left_paddle_y -= MAX_PADDLE_SPEED;
-          else
-            left_paddle_y -= distance;
-        }
-        if (DEBUGGING > 1) {
-          APP_LOG(APP_LOG_LEVEL_DEBUG, "\tleft paddle now @ %d", left_paddle_y);
-        }
-      }
-    }
+  // Let the phone know whenever it cannot work out the game for itself
+  if ((settings & SETTING_MIRROR) && mirror_due) {
+    mirror_send_keyframe();
   }
 
-  // make sure the paddles dont hit the top or bottom
-  if (left_paddle_y < BAR_MARGIN + BAR_HEIGHT - 1)
-    left_paddle_y = BAR_MARGIN + BAR_HEIGHT - 1;
-  if (right_paddle_y < BAR_MARGIN + BAR_HEIGHT - 1)
-    right_paddle_y = BAR_MARGIN + BAR_HEIGHT - 1;
-
-  if (left_paddle_y > (table_size.h - PADDLE_H - BAR_MARGIN - BAR_HEIGHT - 1))
-    left_paddle_y = (table_size.h - PADDLE_H - BAR_MARGIN - BAR_HEIGHT - 1);
-  if (right_paddle_y > (table_size.h - PADDLE_H - BAR_MARGIN - BAR_HEIGHT - 1))
-    right_paddle_y = (table_size.h - PADDLE_H - BAR_MARGIN - BAR_HEIGHT - 1);
-
   // Draw the ball
   graphics_fill_circle(ctx, ball_pos, BALL_RADIUS);
 
   // Draw the paddles
-  graphics_fill_rect(ctx, GRect(left_paddle_x, left_paddle_y, PADDLE_W, PADDLE_H), 1, GCornersAll);
-  graphics_fill_rect(ctx, GRect(right_paddle_x, right_paddle_y, PADDLE_W, PADDLE_H), 1, GCornersAll);
+  graphics_fill_rect(ctx, GRect(left_side.x, left_side.y, PADDLE_W, paddle_h), 1, GCornersAll);
+  graphics_fill_rect(ctx, GRect(right_side.x, right_side.y, PADDLE_W, paddle_h), 1, GCornersAll);
 }
 
 /**
@@ -688,8 +830,14 @@ static void table_layer_update_callback(Layer * const me, GContext * ctx) {
   GRect bounds = layer_get_bounds(me);
 
   // Draw the top and bottom lines
+#ifdef PBL_ROUND
+  GRect ring = GRect(geometry.center.x - round_bar_radius, geometry.center.y - round_bar_radius, round_bar_radius * 2, round_bar_radius * 2);
+  graphics_fill_radial(ctx, ring, GOvalScaleModeFitCircle, BAR_HEIGHT, -round_bar_angle, round_bar_angle);
+  graphics_fill_radial(ctx, ring, GOvalScaleModeFitCircle, BAR_HEIGHT, TRIG_MAX_ANGLE / 2 - round_bar_angle, TRIG_MAX_ANGLE / 2 + round_bar_angle);
+#else
   graphics_fill_rect(ctx, GRect(0, BAR_MARGIN, bounds.size.w, BAR_HEIGHT), 0, GCornerNone);
   graphics_fill_rect(ctx, GRect(0, bounds.size.h - BAR_HEIGHT - BAR_MARGIN, bounds.size.w, BAR_HEIGHT), 0, GCornerNone);
+#endif
 
   // Draw the center line
   uint8_t i;
@@ -723,20 +871,158 @@ static void handle_minute_tick(struct tm *tick_time, TimeUnits units_changed) {
     if (DEBUGGING) { APP_LOG(APP_LOG_LEVEL_DEBUG, "\n\n!!! minute changed !!!\n\n"); }
     minute_changed = 1;
   }
+
+  // The phone cannot know the time has changed, and with it which paddle loses
+  mirror_due = 1;
+}
+
+/**
+ * Current time, in ms.
+ *
+ * @return uint32_t Milliseconds since the epoch (wraps around)
+ */
+static uint32_t now_ms(void) {
+  time_t seconds;
+  uint16_t ms;
+  time_ms(&seconds, &ms);
+  return (uint32_t) seconds * 1000 + ms;
+}
+
+/**
+ * Log a histogram of how far apart animation frames actually are.
+ *
+ * Each frame adds how many ms it came early or late (compared to the frame
+ * time, or with the animation frame clock to the whole number of scheduler
+ * periods it rounds that to) to a bucket. The histogram is logged and cleared every 256 frames.
+ */
+static void record_frame_jitter(void) {
+  static uint32_t last;
+  static uint16_t buckets[JITTER_BUCKETS];
+  static uint8_t frames;
+  uint32_t now = now_ms();
+#ifdef ANIMATION_FRAME_CLOCK
+  const int32_t interval = frame_clock_stride * frame_clock_period / 16;
+#else
+  const int32_t interval = frame_time;
+#endif
+
+  if (last) {
+    uint32_t jitter = abs((int32_t) (now - last) - interval) / JITTER_BUCKET_MS;
+    buckets[jitter < JITTER_BUCKETS ? jitter : JITTER_BUCKETS - 1]++;
+  }
+  last = now;
+
+  if (++frames == 0) {
+    APP_LOG(APP_LOG_LEVEL_DEBUG, "%s jitter (%d ms buckets): %d %d %d %d %d %d %d %d",
+      ANIMATION_FRAME_CLOCK_NAME, JITTER_BUCKET_MS,
+      buckets[0], buckets[1], buckets[2], buckets[3], buckets[4], buckets[5], buckets[6], buckets[7]);
+    memset(buckets, 0, sizeof(buckets));
+  }
+}
+
+/**
+ * Run the next stage of the startup work.
+ *
+ * The first frame is drawn as soon as the window is pushed, showing a static
+ * table; whatever is not needed for that is spread over the frames after it.
+ */
+static void run_startup_stage(void) {
+  switch (startup_stage) {
+    case STARTUP_SYNC:
+      // The phone sends its settings as soon as it is ready; whatever arrives before the inbox is open is lost
+      init_settings_sync();
+      break;
+    case STARTUP_SEED:
+      // Initialize PRNG (and pick up any tuning the phone has sent by now)
+      init_crand();
+      rebuild_tuning();
+      serve_ball();
+      if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "Initial (dx,dy) = (%d,%d)", (int) ball_dx, (int) ball_dy);}
+      if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "started after %d ms", (int) (now_ms() - startup_ms));}
+      break;
+  }
+  startup_stage++;
+}
+
+#ifdef ANIMATION_FRAME_CLOCK
+/**
+ * Pick how many frame clock updates make an animation frame: the whole number
+ * of scheduler periods closest to the frame time (closest as a ratio, so a
+ * 50 ms frame time at 30 updates a second gives 66 ms frames rather than
+ * 33 ms ones).
+ *
+ * The stride only changes once the frame time is an eighth past the midpoint
+ * (the geometric mean of two strides), so a measured period that hovers there
+ * does not flip it back and forth.
+ */
+static void update_frame_clock_stride(void) {
+  // squares of the frame time and period, both in 1/16 ms
+  const uint64_t target = (uint64_t) frame_time * 16 * frame_time * 16;
+  const uint64_t period = (uint64_t) frame_clock_period * frame_clock_period;
+
+  while (frame_clock_stride < UINT8_MAX && target * 8 > (uint64_t) frame_clock_stride * (frame_clock_stride + 1) * period * 9) {
+    frame_clock_stride++;
+  }
+  while (frame_clock_stride > 1 && target * 9 < (uint64_t) (frame_clock_stride - 1) * frame_clock_stride * period * 8) {
+    frame_clock_stride--;
+  }
 }
 
+/**
+ * Frame clock. Called by the system animation scheduler at its own pace;
+ * updates the animation layer every frame_clock_stride updates, so every
+ * frame is the same whole number of scheduler periods long and the game never
+ * judders between short and long frames. The frame time setting is rounded to
+ * that (see update_frame_clock_stride()).
+ *
+ * @param animation The frame clock
+ * @param progress  Unused (the animation never ends)
+ */
+static void frame_clock_update(Animation *animation, const AnimationProgress progress) {
+  uint32_t now = now_ms();
+  uint32_t elapsed = (now - frame_clock_last) * 16;
+  frame_clock_last = now;
+
+  // The scheduler's period is not in the SDK, so measure it (ignoring stalls)
+  if (elapsed > frame_clock_period * 2u) {
+    elapsed = frame_clock_period * 2u;
+  }
+  frame_clock_period += ((int32_t) elapsed - frame_clock_period) / 8;
+  update_frame_clock_stride();
+
+  if (++frame_clock_updates >= frame_clock_stride) {
+    frame_clock_updates = 0;
+    if (startup_stage != STARTUP_DONE) {
+      run_startup_stage();
+    }
+    // Update animation layer
+    frame_due = 1;
+    layer_mark_dirty(anim_layer);
+  }
+}
+
+static const AnimationImplementation frame_clock_implementation = {
+  .update = frame_clock_update
+};
+#else
 /**
  * Animation timer. Update animation layer.
  *
  */
 static void timer_callback(void *data) {
+  if (startup_stage != STARTUP_DONE) {
+    run_startup_stage();
+  }
+
   // Update animation layer
+  frame_due = 1;
   layer_mark_dirty(anim_layer);
 
   // Schedule the next update
-  const uint32_t timeout_ms = ANIM_FRAME_TIME;
+  const uint32_t timeout_ms = frame_time;
   timer = app_timer_register(timeout_ms, timer_callback, NULL);
 }
+#endif
 
 /**
  * Called when there is a settings sync error.
@@ -746,6 +1032,20 @@ static void timer_callback(void *data) {
 static void settings_sync_error_callback(DictionaryResult dict_error, AppMessageResult app_message_error, void *context) {
 }
 
+/**
+ * Limit a tunable setting to a sane range.
+ *
+ * @param value Value received from the phone
+ * @param min   Smallest allowed value
+ * @param max   Largest allowed value
+ * @return uint16_t The value, clamped to [min, max]
+ */
+static uint16_t clamp_setting(uint16_t value, uint16_t min, uint16_t max) {
+  if (value < min) return min;
+  if (value > max) return max;
+  return value;
+}
+
 /**
  * Called when a settings tuple has changed.
  *
@@ -772,9 +1072,87 @@ static void settings_sync_tuple_changed_callback(const uint32_t key, const Tuple
       window_set_background_color(window, (settings & SETTING_INVERTED) > 0 ? GColorWhite : GColorBlack);
 
       break;
+    case SETTING_SYNC_KEY_BALL_SPEED:
+      // any faster and the ball could reach the wall before the paddle sees it; any slower
+      // and every serve rounds to the same 45 degree vector
+      ball_speed = clamp_setting(new_tuple->value->uint8, 50, 100);
+      tuning_stale = 1;
+      break;
+    case SETTING_SYNC_KEY_PADDLE_SIZE:
+      paddle_h = clamp_setting(new_tuple->value->uint8, 12, 40);
+      tuning_stale = 1;
+      break;
+    case SETTING_SYNC_KEY_PADDLE_SPEED:
+      paddle_speed = clamp_setting(new_tuple->value->uint8, 8, 30);
+      tuning_stale = 1;
+      break;
+    case SETTING_SYNC_KEY_FRAME_TIME:
+      // picked up when the next frame is scheduled
+      frame_time = clamp_setting(new_tuple->value->uint16, 20, 1000);
+      break;
+    case SETTING_SYNC_KEY_MIRROR:
+      if (0 == ((uint8_t) new_tuple->value->uint8)) settings = settings & ~SETTING_MIRROR;
+      else settings = settings | SETTING_MIRROR;
+
+      // Start the phone off with a full keyframe
+      mirror_due = 1;
+
+      break;
+  }
+}
+
+#ifdef UNOBSTRUCTED_RELAYOUT
+/**
+ * Map a vertical position from one range onto another.
+ *
+ * @param y           Vertical position within the old range
+ * @param from_top    Top of the old range
+ * @param from_bottom Bottom of the old range
+ * @param to_top      Top of the new range
+ * @param to_bottom   Bottom of the new range
+ * @return int16_t Vertical position within the new range
+ */
+static int16_t rescale_y(int16_t y, int16_t from_top, int16_t from_bottom, int16_t to_top, int16_t to_bottom) {
+  if (from_bottom == from_top) {
+    return to_top;
   }
+  return to_top + ((int32_t) (y - from_top) * (to_bottom - to_top)) / (from_bottom - from_top);
 }
 
+/**
+ * Called while the unobstructed area of the screen changes.
+ *
+ * Shrinks or grows the table to fit the unobstructed area and rescales the ball
+ * and paddles into it, without restarting the rally.
+ *
+ * @param progress How far along the change is
+ * @param context  Unused
+ */
+static void unobstructed_area_change_callback(AnimationProgress progress, void *context) {
+  GRect bounds = layer_get_unobstructed_bounds(window_get_root_layer(window));
+  if (bounds.size.h == geometry.size.h) {
+    return;
+  }
+  const TableGeometry old = geometry;
+  init_geometry(bounds.size);
+
+  layer_set_frame(table_layer, GRect(0, 0, bounds.size.w, bounds.size.h));
+  layer_set_frame(anim_layer, GRect(0, 0, bounds.size.w, bounds.size.h));
+
+  ball_pos.y = rescale_y(ball_pos.y, old.ball_top, old.ball_bottom, geometry.ball_top, geometry.ball_bottom);
+  ball_prev_pos.y = rescale_y(ball_prev_pos.y, old.ball_top, old.ball_bottom, geometry.ball_top, geometry.ball_bottom);
+  place_paddle(&left_side, rescale_y(left_side.y, old.paddle_top, old.paddle_floor - paddle_h, geometry.paddle_top, geometry.paddle_floor - paddle_h));
+  place_paddle(&right_side, rescale_y(right_side.y, old.paddle_top, old.paddle_floor - paddle_h, geometry.paddle_top, geometry.paddle_floor - paddle_h));
+  paddle_bottom = PADDLE_FLOOR - paddle_h;
+
+  // The ball keeps its vector, so the in-flight prediction is redone on the next frame
+  keepout_stale = 1;
+  mirror_due = 1;
+
+  if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "relayout %d -> %d", old.size.h, geometry.size.h);}
+}
+#endif
+
 /**
  * Called when the window is pushed to the screen when it's not loaded.
  *
@@ -784,7 +1162,11 @@ static void settings_sync_tuple_changed_callback(const uint32_t key, const Tuple
  */
 static void window_load(Window *window) {
   Layer *window_layer = window_get_root_layer(window);
+#ifdef UNOBSTRUCTED_RELAYOUT
+  GRect bounds = layer_get_unobstructed_bounds(window_layer);
+#else
   GRect bounds = layer_get_bounds(window_layer);
+#endif
 
   // Initialize score layer
   failed = 0;
@@ -800,31 +1182,37 @@ static void window_load(Window *window) {
 
   // Initialize a graphics layer for the table
   table_layer = layer_create(GRect(0, 0, bounds.size.w, bounds.size.h));
-  table_size = GSize(bounds.size.w, bounds.size.h);
   if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "table_layer bounds = %d, %d", bounds.size.w, bounds.size.h);}
-  if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "table_size = %d, %d", table_size.w, table_size.h);}
+  init_geometry(bounds.size);
   layer_set_update_proc(table_layer, table_layer_update_callback);
   layer_add_child(window_layer, table_layer);
 
   // Initialize a graphics layer for the animation
   minute_changed = 0;
   hour_changed = 0;
-  left_paddle_x = PADDLE_MARGIN;
-  right_paddle_x = bounds.size.w - PADDLE_W - PADDLE_MARGIN;
-  left_paddle_y = (bounds.size.h - PADDLE_H) / 2;
-  right_paddle_y = (bounds.size.h - PADDLE_H) / 2;
+  left_side.x = geometry.left_paddle_x;
+  left_side.face = geometry.left_paddle_x + PADDLE_W + BALL_RADIUS;
+  place_paddle(&left_side, (geometry.size.h - paddle_h) / 2);
+  right_side.x = geometry.right_paddle_x;
+  right_side.face = geometry.right_paddle_x - BALL_RADIUS - 1;
+  place_paddle(&right_side, (geometry.size.h - paddle_h) / 2);
   anim_layer = layer_create(GRect(0, 0, bounds.size.w, bounds.size.h));
 
-  float angle = random_angle_rads();
-  ball_pos = GPoint(bounds.size.w / 2, bounds.size.h / 2);
-  ball_dx = MAX_BALL_SPEED * safe_cos(angle);
-  ball_dy = MAX_BALL_SPEED * safe_sin(angle);
-  if (DEBUGGING) {APP_LOG(APP_LOG_LEVEL_DEBUG, "Initial (dx,dy) = (%d,%d)", (int) ball_dx, (int) ball_dy);}
+  // The ball waits at the center until it is served (see run_startup_stage)
+  ball_pos = geometry.center;
+  ball_dx = ball_dy = 0;
   layer_set_update_proc(anim_layer, anim_layer_update_callback);
   layer_add_child(window_layer, anim_layer);
 
   // Subscribe to tick timer service to update watchface every minute
   tick_timer_service_subscribe(MINUTE_UNIT, handle_minute_tick);
+
+#ifdef UNOBSTRUCTED_RELAYOUT
+  // Fit the table to whatever part of the screen is not covered
+  unobstructed_area_service_subscribe((UnobstructedAreaHandlers) {
+    .change = unobstructed_area_change_callback
+  }, NULL);
+#endif
 }
 
 /**
@@ -835,20 +1223,44 @@ static void window_load(Window *window) {
  * @param window Pointer to Window object
  */
 static void window_unload(Window *window) {
+#ifdef UNOBSTRUCTED_RELAYOUT
+  unobstructed_area_service_unsubscribe();
+#endif
   text_layer_destroy(score_layer);
   layer_destroy(anim_layer);
   layer_destroy(table_layer);
 }
 
+/**
+ * Load settings and init sync with JS app on phone.
+ *
+ */
+static void init_settings_sync(void) {
+  Tuplet initial_settings[] = {
+    TupletInteger(SETTING_SYNC_KEY_12H_TIME, 0),
+    TupletInteger(SETTING_SYNC_KEY_INVERTED, 0),
+    TupletInteger(SETTING_SYNC_KEY_MIRROR, 0),
+    TupletInteger(SETTING_SYNC_KEY_BALL_SPEED, 100),
+    TupletInteger(SETTING_SYNC_KEY_PADDLE_SIZE, PADDLE_H),
+    TupletInteger(SETTING_SYNC_KEY_PADDLE_SPEED, PADDLE_SPEED),
+    TupletInteger(SETTING_SYNC_KEY_FRAME_TIME, ANIM_FRAME_TIME)
+  };
+  app_sync_init(&settings_sync, settings_sync_buffer, sizeof(settings_sync_buffer), initial_settings, ARRAY_LENGTH(initial_settings),
+    settings_sync_tuple_changed_callback, settings_sync_error_callback, NULL
+  );
+  app_message_open(128, 64);
+}
+
 /**
  * Initialize the app
  *
  */
 static void init(void) {
   settings = 0;
-
-  // Initialize PRNG
-  init_crand();
+  startup_stage = STARTUP_SYNC;
+  if (DEBUGGING) {
+    startup_ms = now_ms();
+  }
 
   // Initialize window
   window = window_create();
@@ -859,19 +1271,17 @@ static void init(void) {
   });
   window_stack_push(window, true);
 
-  // Load settings and init sync with JS app on phone
-  Tuplet initial_settings[] = {
-    TupletInteger(SETTING_SYNC_KEY_12H_TIME, 0),
-    TupletInteger(SETTING_SYNC_KEY_INVERTED, 0)
-  };
-  app_sync_init(&settings_sync, settings_sync_buffer, sizeof(settings_sync_buffer), initial_settings, ARRAY_LENGTH(initial_settings),
-    settings_sync_tuple_changed_callback, settings_sync_error_callback, NULL
-  );
-  app_message_open(64, 64);
-
   // Schedule animation update
-  const uint32_t timeout_ms = ANIM_FRAME_TIME;
+#ifdef ANIMATION_FRAME_CLOCK
+  frame_clock = animation_create();
+  animation_set_implementation(frame_clock, &frame_clock_implementation);
+  animation_set_duration(frame_clock, ANIMATION_DURATION_INFINITE);
+  frame_clock_last = now_ms();
+  animation_schedule(frame_clock);
+#else
+  const uint32_t timeout_ms = frame_time;
   timer = app_timer_register(timeout_ms, timer_callback, NULL);
+#endif
 }
 
 /**
@@ -880,6 +1290,13 @@ static void init(void) {
  */
 static void deinit(void) {
   //app_sync_deinit(&settings_sync);
+#ifdef ANIMATION_FRAME_CLOCK
+  animation_unschedule(frame_clock);
+#ifndef PBL_SDK_3
+  // SDK 3 destroys an animation when it is unscheduled; SDK 2 leaves that to us
+  animation_destroy(frame_clock);
+#endif
+#endif
   tick_timer_service_unsubscribe();
   window_destroy(window);
 }
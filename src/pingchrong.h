@@ -1,6 +1,8 @@
 #ifndef PINGCHRONG_H
 #define PINGCHRONG_H
 
+// Defaults for the settings below can be changed on the phone
+
 // This is a tradeoff between sluggish and too fast to see
 #define MAX_BALL_SPEED 1 // note this is in vector arithmetic
 
@@ -10,14 +12,46 @@
 // The length of one animation frame in ms
 #define ANIM_FRAME_TIME 50
 
+// Set to 1 to pace frames with the system animation scheduler rather than an AppTimer
+#ifndef USE_ANIMATION_FRAME_CLOCK
+#define USE_ANIMATION_FRAME_CLOCK 0
+#endif
+#if USE_ANIMATION_FRAME_CLOCK
+#ifndef ANIMATION_DURATION_INFINITE
+#error "USE_ANIMATION_FRAME_CLOCK needs an SDK with endless animations (ANIMATION_DURATION_INFINITE)"
+#endif
+#define ANIMATION_FRAME_CLOCK
+// Nominal time between system animation updates (ms); the frame clock measures the real one as it runs
+#define ANIMATION_SCHEDULER_PERIOD 33
+#ifndef PBL_SDK_3
+// SDK 2 passes animation updates the normalized time; SDK 3 calls it progress
+typedef uint32_t AnimationProgress;
+#endif
+#endif
+
+// Frame jitter histogram (for debugging): bucket width in ms and number of buckets
+#define JITTER_BUCKET_MS 5
+#define JITTER_BUCKETS 8
+
 // If the angle is too shallow or too narrow, the game is boring
 #define MIN_BALL_ANGLE 20
 
-// Paddle size (in pixels) and max speed for AI
+// Number of (whole degree) angles a ball can be served at within a quadrant
+#define SERVE_ANGLES (90 - MIN_BALL_ANGLE * 2)
+
+// Paddle size (in pixels) and average speed for AI (pixels per frame over a move; the eased
+// move peaks at 1.5x this halfway through)
 #define PADDLE_H 20
 #define PADDLE_W 3
+#ifdef PBL_ROUND
+#define PADDLE_MARGIN 16 // horizontal space between paddles and edge of screen (pulled in from the bezel)
+#else
 #define PADDLE_MARGIN 2 // horizontal space between paddles and edge of screen
-#define MAX_PADDLE_SPEED 10
+#endif
+#define PADDLE_SPEED 10
+
+// Number of intervals in the paddle easing table
+#define PADDLE_EASE_STEPS 16
 
 // How thick the top and bottom lines are in pixels
 #define BAR_HEIGHT 2
@@ -25,21 +59,124 @@
 // How far from the screen edge the top and bottom lines are
 #define BAR_MARGIN 2
 
+// Size (in bytes) of a game state keyframe sent to the phone
+#define MIRROR_KEYFRAME_SIZE 37
+
+// Size of the table when the screen is known at build time
+#if defined(PBL_PLATFORM_EMERY)
+#define TABLE_WIDTH 200
+#define TABLE_HEIGHT 228
+#elif defined(PBL_PLATFORM_CHALK)
+#define TABLE_WIDTH 180
+#define TABLE_HEIGHT 180
+#elif defined(PBL_PLATFORM_APLITE) || defined(PBL_PLATFORM_BASALT) || defined(PBL_PLATFORM_DIORITE)
+#define TABLE_WIDTH 144
+#define TABLE_HEIGHT 168
+#endif
+
+// Re-layout the table when a timeline peek or other overlay covers part of the screen
+#ifdef PBL_API_EXISTS
+#if PBL_API_EXISTS(unobstructed_area_service_subscribe) && !defined(PBL_ROUND)
+#define UNOBSTRUCTED_RELAYOUT 1
+#endif
+#endif
+
+// Table geometry; everything the animation needs to know about walls and paddles
+typedef struct {
+  GSize size; // size (in pixels) of the table
+  GPoint center; // where the ball is served from
+  int16_t ball_top; // topmost position of ball's center (top wall)
+  int16_t ball_bottom; // bottommost position of ball's center (bottom wall)
+  int16_t ball_right; // ball's center beyond this has hit the right edge of the screen
+  int16_t sim_top; // top wall as seen by the keepout simulation
+  int16_t paddle_top; // topmost position of a paddle
+  int16_t paddle_floor; // lowest position of a paddle's bottom edge
+  int16_t left_paddle_x; // horizontal position of left paddle
+  int16_t right_paddle_x; // horizontal position of right paddle
+} TableGeometry;
+
+// Work out the table geometry for a table of the given size (usable as a constant initializer)
+#define TABLE_GEOMETRY(w, h) { \
+  .size = { (w), (h) }, \
+  .center = { (w) / 2, (h) / 2 }, \
+  .ball_top = BAR_MARGIN + BAR_HEIGHT + BALL_RADIUS - 1, \
+  .ball_bottom = (h) - BAR_MARGIN - BAR_HEIGHT - BALL_RADIUS - 1, \
+  .ball_right = (w) - BALL_RADIUS - 1, \
+  .sim_top = BAR_MARGIN + BAR_HEIGHT + BALL_RADIUS, \
+  .paddle_top = BAR_MARGIN + BAR_HEIGHT - 1, \
+  .paddle_floor = (h) - BAR_MARGIN - BAR_HEIGHT - 1, \
+  .left_paddle_x = PADDLE_MARGIN, \
+  .right_paddle_x = (w) - PADDLE_W - PADDLE_MARGIN \
+}
+
+// A paddle move, planned once per rally and then played back one frame at a time
+typedef struct {
+  int16_t start_y; // vertical position of the paddle when the move was planned
+  int16_t delta_y; // total vertical distance to travel
+  uint16_t phase; // progress through the easing table (8.8 fixed point)
+  uint16_t phase_step; // progress made per animation frame (8.8 fixed point)
+} PaddleMotion;
+
+// One side of the table: a paddle and the AI that controls it
+typedef struct {
+  int8_t dir; // sign of the ball's horizontal vector when it is heading towards this paddle
+  char name; // 'L' or 'R' (for debugging)
+  uint8_t *lose_flag; // set when this paddle should miss the ball
+  int16_t x; // horizontal position of paddle
+  int16_t face; // horizontal position of the ball's center when it touches the paddle
+  int16_t y; // vertical position of paddle
+  int16_t prev_y; // vertical position of paddle in previous animation frame
+  // The keepout is used to know where to -not- put the paddle
+  // the 'bouncepos' is where we expect the ball's y-coord to be when
+  // it intersects with the paddle area
+  uint8_t keepout_top, keepout_bot, bouncepos, endpos;
+  uint8_t ticks; // animation frames until the ball reaches the paddle
+  PaddleMotion motion; // planned move of paddle
+} PaddleSide;
+
 static void anim_layer_update_callback(Layer * const me, GContext * ctx);
-static uint8_t calculate_keepout(float theball_x, float theball_y, float theball_dx, float theball_dy, uint8_t *keepout1, uint8_t *keepout2);
+static uint8_t calculate_keepout(const PaddleSide *side, float theball_x, float theball_y, float theball_dx, float theball_dy, uint8_t *keepout1, uint8_t *keepout2);
+static uint16_t clamp_setting(uint16_t value, uint16_t min, uint16_t max);
 static uint16_t crand(uint8_t type);
 static void deinit(void);
 static void encipher(void);
+#ifdef ANIMATION_FRAME_CLOCK
+static void frame_clock_update(Animation *animation, const AnimationProgress progress);
+#endif
 static void handle_minute_tick(struct tm *tick_time, TimeUnits units_changed);
 static void init(void);
 static void init_crand(void);
+static void init_geometry(GSize size);
+static void init_settings_sync(void);
+static void place_paddle(PaddleSide *side, int16_t y);
+static void plan_paddle_motion(PaddleMotion *motion, int16_t from_y, int16_t to_y, uint8_t ticks);
+#ifdef PBL_ROUND
+static int16_t isqrt(int32_t n);
+#endif
 static uint8_t intersectrect(uint8_t x1, uint8_t y1, uint8_t w1, uint8_t h1, uint8_t x2, uint8_t y2, uint8_t w2, uint8_t h2);
-static float random_angle_rads(void);
+static void mirror_pack_motion(uint8_t *data, const PaddleMotion *motion);
+static void mirror_send_keyframe(void);
+static uint32_t now_ms(void);
+static void record_frame_jitter(void);
+static void rebuild_tuning(void);
+static void run_startup_stage(void);
 static int safe_cos(float angle);
 static int safe_sin(float angle);
+static void serve_ball(void);
 static void set_score(void);
+static int16_t step_paddle_motion(PaddleMotion *motion);
+#ifdef UNOBSTRUCTED_RELAYOUT
+static int16_t rescale_y(int16_t y, int16_t from_top, int16_t from_bottom, int16_t to_top, int16_t to_bottom);
+static void unobstructed_area_change_callback(AnimationProgress progress, void *context);
+#endif
 static void table_layer_update_callback(Layer * const me, GContext * ctx);
+#ifndef ANIMATION_FRAME_CLOCK
 static void timer_callback(void *data);
+#endif
+#ifdef ANIMATION_FRAME_CLOCK
+static void update_frame_clock_stride(void);
+#endif
+static void update_paddle(PaddleSide *side, GContext *ctx);
 static void window_load(Window *window);
 static void window_unload(Window *window);
 
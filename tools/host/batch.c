@@ -0,0 +1,156 @@
+/**
+ * Check the batch keepout solver against the watch code, and time both.
+ *
+ * Usage: batch [-n balls] [-r seed]
+ *
+ * Solves the same random balls (anywhere between the paddles, heading either
+ * way, at any speed a serve or a bounce gives) with the watch's own
+ * calculate_keepout(), with keepout_batch() and with keepout_batch_scalar(),
+ * and exits non-zero unless all three agree on every ball, bit for bit.
+ */
+#include <getopt.h>
+#include "host.h"
+
+// Fastest the ball moves along either axis, in pixels per frame
+#define MAX_BALL_STEP 6.0f
+
+static uint32_t count = 100000; /**< Balls to solve for each side */
+static uint32_t seed = 1;
+static int status;
+
+/** Answers for one batch */
+typedef struct {
+  uint8_t *ticks, *keepout1, *keepout2;
+} Answers;
+
+static float random_float(float min, float max) {
+  // xorshift32
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return min + (max - min) * (seed >> 8) / (float) (1 << 24);
+}
+
+static double now_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+  return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static void answers_alloc(Answers *answers) {
+  answers->ticks = calloc(count, 1);
+  answers->keepout1 = calloc(count, 1);
+  answers->keepout2 = calloc(count, 1);
+}
+
+static void answers_use(KeepoutBatch *batch, const Answers *answers) {
+  batch->ticks = answers->ticks;
+  batch->keepout1 = answers->keepout1;
+  batch->keepout2 = answers->keepout2;
+}
+
+/**
+ * Count the balls two solvers disagree on, printing the first few.
+ */
+static uint32_t compare(const char *name, const KeepoutBatch *batch, const Answers *expected, const Answers *actual) {
+  uint32_t i, mismatches = 0;
+
+  for (i = 0; i < count; i++) {
+    if (expected->ticks[i] != actual->ticks[i] || expected->keepout1[i] != actual->keepout1[i] || expected->keepout2[i] != actual->keepout2[i]) {
+      if (mismatches++ < 5) {
+        printf("  %s differs for ball (%a, %a) moving (%a, %a): %u tix, %u, %u instead of %u tix, %u, %u\n", name,
+          batch->x[i], batch->y[i], batch->dx[i], batch->dy[i], actual->ticks[i], actual->keepout1[i], actual->keepout2[i],
+          expected->ticks[i], expected->keepout1[i], expected->keepout2[i]);
+      }
+    }
+  }
+  return mismatches;
+}
+
+/**
+ * Solve count random balls heading towards one side all three ways.
+ *
+ * @param dir Side the balls are heading towards (-1 left, 1 right)
+ */
+static void check_side(int8_t dir) {
+  float *x = malloc(count * sizeof(float)), *y = malloc(count * sizeof(float));
+  float *dx = malloc(count * sizeof(float)), *dy = malloc(count * sizeof(float));
+  Answers watch, vector, scalar;
+  KeepoutTable table;
+  KeepoutBatch batch = { .count = count, .x = x, .y = y, .dx = dx, .dy = dy };
+  double start, watch_ns, vector_ns, scalar_ns;
+  uint32_t i, mismatches;
+
+  host_keepout_table(&table, dir);
+  for (i = 0; i < count; i++) {
+    x[i] = random_float(table.left_paddle_x, table.right_paddle_x + table.paddle_w);
+    y[i] = random_float(0, host_screen_height());
+    dx[i] = dir * random_float(0.5f, MAX_BALL_STEP);
+    dy[i] = random_float(-MAX_BALL_STEP, MAX_BALL_STEP);
+  }
+  answers_alloc(&watch);
+  answers_alloc(&vector);
+  answers_alloc(&scalar);
+
+  start = now_ns();
+  for (i = 0; i < count; i++) {
+    watch.ticks[i] = host_calculate_keepout(dir, x[i], y[i], dx[i], dy[i], &watch.keepout1[i], &watch.keepout2[i]);
+  }
+  watch_ns = now_ns() - start;
+
+  answers_use(&batch, &vector);
+  start = now_ns();
+  keepout_batch(&table, &batch);
+  vector_ns = now_ns() - start;
+
+  answers_use(&batch, &scalar);
+  start = now_ns();
+  keepout_batch_scalar(&table, &batch);
+  scalar_ns = now_ns() - start;
+
+  mismatches = compare("keepout_batch", &batch, &watch, &vector) + compare("keepout_batch_scalar", &batch, &watch, &scalar);
+  printf("  towards the %s paddle: %u balls, %u mismatches; %.1f ns/ball watch code, %.1f scalar, %.1f in %u lanes\n",
+    dir < 0 ? "left" : "right", count, mismatches, watch_ns / count, scalar_ns / count, vector_ns / count, keepout_batch_lanes());
+  if (mismatches) {
+    status = 1;
+  }
+
+  free(x); free(y); free(dx); free(dy);
+  free(watch.ticks); free(watch.keepout1); free(watch.keepout2);
+  free(vector.ticks); free(vector.keepout1); free(vector.keepout2);
+  free(scalar.ticks); free(scalar.keepout1); free(scalar.keepout2);
+}
+
+void host_run(void) {
+  HostGame game;
+
+  host_start_game(&game);
+  printf("%s %dx%d: keepouts, watch code against the batch solver\n", HOST_PLATFORM, host_screen_width(), host_screen_height());
+  check_side(-1);
+  check_side(1);
+}
+
+int main(int argc, char **argv) {
+  int opt;
+
+  while ((opt = getopt(argc, argv, "n:r:")) != -1) {
+    switch (opt) {
+      case 'n':
+        count = atoi(optarg);
+        break;
+      case 'r':
+        seed = atoi(optarg);
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-n balls] [-r seed]\n", argv[0]);
+        return 2;
+    }
+  }
+  if (count < 1 || seed == 0) {
+    fprintf(stderr, "balls and seed must be at least 1\n");
+    return 2;
+  }
+
+  pingchrong_main();
+  return status;
+}
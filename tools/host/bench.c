@@ -0,0 +1,79 @@
+/**
+ * Frame time benchmark: how long the watchface's own code takes per frame.
+ *
+ * Usage: bench [-n frames] [-r runs]
+ *
+ * Plays past startup, then times runs of frames in process CPU time with
+ * drawing into the stub framebuffer switched off (the layer update procs
+ * still run, so the watchface pays for making every draw call but not the
+ * stub for rasterizing it). The fastest run is the one the host disturbed
+ * least, so that is the figure to compare; make bench-compare BASE=<rev>
+ * alternates this build with an older revision's and keeps the fastest of each.
+ */
+#include <getopt.h>
+#include "host.h"
+
+#define MAX_RUNS 64
+
+static uint32_t frames = 20000; /**< Frames per timed run */
+static int runs = 15;
+static double ns_per_frame[MAX_RUNS];
+
+static double now_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+  return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+  double x = *(const double *) a, y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+void host_run(void) {
+  HostGame game;
+  uint32_t frame;
+  double start;
+  int i;
+
+  host_start_game(&game);
+  host_rasterize = 0;
+  for (frame = 0; frame < frames / 4; frame++) {
+    host_step();
+  }
+  for (i = 0; i < runs; i++) {
+    start = now_ns();
+    for (frame = 0; frame < frames; frame++) {
+      host_step();
+    }
+    ns_per_frame[i] = (now_ns() - start) / frames;
+  }
+  qsort(ns_per_frame, runs, sizeof(double), compare_doubles);
+  printf("%s: fastest %.1f ns/frame (median %.1f, slowest %.1f of %d runs of %u frames)\n", HOST_PLATFORM,
+    ns_per_frame[0], ns_per_frame[runs / 2], ns_per_frame[runs - 1], runs, frames);
+}
+
+int main(int argc, char **argv) {
+  int opt;
+
+  while ((opt = getopt(argc, argv, "n:r:")) != -1) {
+    switch (opt) {
+      case 'n':
+        frames = atoi(optarg);
+        break;
+      case 'r':
+        runs = atoi(optarg);
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-n frames] [-r runs]\n", argv[0]);
+        return 2;
+    }
+  }
+  if (frames < 1 || runs < 1 || runs > MAX_RUNS) {
+    fprintf(stderr, "frames must be at least 1 and runs 1..%d\n", MAX_RUNS);
+    return 2;
+  }
+
+  pingchrong_main();
+  return 0;
+}
@@ -0,0 +1,121 @@
+/**
+ * Measure how evenly a frame clock paces animation frames.
+ *
+ * Usage: clock [-t minutes] [-f frame_time_ms] [-l latency_ms] [-a animation_interval_ms] [-h]
+ *
+ * Builds with CLOCK=timer (AppTimer, the default) and CLOCK=animation
+ * (USE_ANIMATION_FRAME_CLOCK) pace frames differently: the timer clock asks
+ * for the frame time (-f) and gets it late, while the animation clock rounds
+ * it to a whole number of the system scheduler's updates (-a). Timers and
+ * animation updates are both delivered up to -l ms late.
+ *
+ * What shows on screen as judder is frames of uneven length, so each frame
+ * is compared with the average frame length of the run, not with the frame
+ * time asked for; how far that average is from the frame time is reported
+ * separately (it is how much faster or slower the game runs). Prints one
+ * line per run, so make jitter can sweep the stub's parameters rather than
+ * rest on one guess at them; -h prints the header.
+ */
+#include <getopt.h>
+#include "host.h"
+
+#ifdef USE_ANIMATION_FRAME_CLOCK
+#define CLOCK_NAME "animation"
+#else
+#define CLOCK_NAME "timer"
+#endif
+
+// Must match JITTER_BUCKET_MS and JITTER_BUCKETS in pingchrong.h
+#define BUCKET_MS 5
+#define BUCKETS 8
+
+#define MAX_FRAMES 200000
+
+static uint32_t minutes = 10; /**< How long to play for (virtual time) */
+static int32_t frame_time = 50; /**< Frame time setting */
+static uint16_t intervals[MAX_FRAMES]; /**< Time between each frame and the one before it */
+
+void host_run(void) {
+  const uint64_t end_ms = (uint64_t) minutes * 60000;
+  uint32_t buckets[BUCKETS] = {0};
+  uint32_t last_frame = 0, frames = 0, i;
+  uint64_t last_ms = 0, start_ms = 0;
+  double mean, worst = 0;
+  HostGame game;
+
+  host_start_game(&game);
+  host_sync_setting(HOST_KEY_FRAME_TIME, frame_time);
+  while (host_now_ms() < end_ms && frames < MAX_FRAMES && host_step()) {
+    host_game(&game);
+    if (game.frame_count == last_frame) {
+      continue;
+    }
+    if (last_ms) {
+      intervals[frames++] = host_now_ms() - last_ms;
+    } else {
+      start_ms = host_now_ms();
+    }
+    last_frame = game.frame_count;
+    last_ms = host_now_ms();
+  }
+  if (!frames) {
+    return;
+  }
+
+  mean = (double) (last_ms - start_ms) / frames;
+  for (i = 0; i < frames; i++) {
+    double off = intervals[i] > mean ? intervals[i] - mean : mean - intervals[i];
+    uint32_t bucket = off / BUCKET_MS;
+    buckets[bucket < BUCKETS ? bucket : BUCKETS - 1]++;
+    if (off > worst) {
+      worst = off;
+    }
+  }
+
+  printf("%-9s  %5d  %7d  %5d  %9.1f  %+6.0f%%  %6.1f  %5.1f", CLOCK_NAME, frame_time,
+#ifdef USE_ANIMATION_FRAME_CLOCK
+    host_animation_interval_ms,
+#else
+    0,
+#endif
+    host_timer_latency_ms, mean, 100.0 * (frame_time / mean - 1), worst, 100.0 * buckets[0] / frames);
+  for (i = 0; i < BUCKETS; i++) {
+    printf(" %u", buckets[i]);
+  }
+  printf("\n");
+}
+
+int main(int argc, char **argv) {
+  int opt;
+
+  while ((opt = getopt(argc, argv, "t:f:l:a:h")) != -1) {
+    switch (opt) {
+      case 't':
+        minutes = atoi(optarg);
+        break;
+      case 'f':
+        frame_time = atoi(optarg);
+        break;
+      case 'l':
+        host_timer_latency_ms = atoi(optarg);
+        break;
+      case 'a':
+        host_animation_interval_ms = atoi(optarg);
+        break;
+      case 'h':
+        printf("clock      frame  updates  late   ms/frame    speed   worst  even%%  frames off the average by 0-%d, %d-%d, ... ms\n",
+          BUCKET_MS, BUCKET_MS, BUCKET_MS * 2);
+        return 0;
+      default:
+        fprintf(stderr, "usage: %s [-t minutes] [-f frame_time_ms] [-l latency_ms] [-a animation_interval_ms] [-h]\n", argv[0]);
+        return 2;
+    }
+  }
+  if (minutes < 1 || frame_time < 20 || frame_time > 1000 || host_animation_interval_ms < 1) {
+    fprintf(stderr, "minutes must be at least 1, frame time 20..1000 and the animation interval at least 1\n");
+    return 2;
+  }
+
+  pingchrong_main();
+  return 0;
+}
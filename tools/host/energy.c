@@ -0,0 +1,235 @@
+/**
+ * Energy cost model: a rough mAh/day for each frame rate, with and without
+ * mirroring, and with a frame rate that adapts to where the ball is.
+ *
+ * Usage: energy [-t hours] [-c name=value]... [-l]
+ *
+ * Each scenario is played in a fresh process (the watchface keeps its state
+ * in statics) for a while of virtual time once the ball is in play. The work
+ * the watch did is counted: wakeups, game steps, ball steps simulated by the
+ * keepout solver, PRNG steps, layers, text and graphics calls drawn, pixels
+ * written, display rows sent and AppMessages. The CPU work is turned into
+ * cycles with the cycles table below (started from the static Thumb-2 counts
+ * of make thumb), and cycles and everything else into charge with the cost
+ * table. Both are order-of-magnitude figures, not measurements from a watch,
+ * so compare the scenarios with each other rather than trusting the absolute
+ * numbers; -c tries other figures and -l lists them.
+ */
+#include <getopt.h>
+#include <string.h>
+#include "host.h"
+
+// Microcoulombs in a milliamp hour
+#define UC_PER_MAH 3600000.0
+
+// Frame times of the adaptive scenario: fast while the ball is in the quarter of the table
+// nearest the paddle it is heading for (the bounce and the paddle's move), slow elsewhere
+#define ADAPTIVE_NEAR_MS 33
+#define ADAPTIVE_FAR_MS 100
+
+/** Price of one kind of work the watch does */
+typedef struct {
+  const char *name; /**< Name to override it by, with -c */
+  double value;
+  const char *unit;
+  const char *what;
+} Cost;
+
+static Cost costs[] = {
+  { "idle", 200, "uA", "drawn all the time, asleep or not" },
+  { "wakeup", 3, "uC", "each time the CPU wakes to deliver a timer, animation or tick event" },
+  { "mcycle", 125, "uC", "each million CPU cycles (about 8 mA while running at 64 MHz)" },
+  { "row", 0.5, "uC", "each row sent to the display" },
+  { "message", 25, "uC", "each AppMessage sent to the phone" },
+  { "byte", 0.2, "uC", "each byte of those AppMessages" },
+  { "step", 2500, "cycles", "each game step outside the keepout solver and PRNG (ball, paddles, misses)" },
+  { "keepout", 500, "cycles", "each ball step simulated by the keepout solver (about 40 instructions and 11 soft-float calls)" },
+  { "encipher", 450, "cycles", "each PRNG step (32 XTEA rounds)" },
+  { "layer", 300, "cycles", "each layer drawn in a redraw" },
+  { "text", 15000, "cycles", "each text layer drawn (the score's glyphs)" },
+  { "draw", 400, "cycles", "each graphics fill or draw call, before its pixels" },
+  { "pixel", 2, "cycles", "each pixel written to the framebuffer" }
+};
+#define COST_COUNT (sizeof(costs) / sizeof(costs[0]))
+
+enum {
+  COST_IDLE, COST_WAKEUP, COST_MCYCLE, COST_ROW, COST_MESSAGE, COST_BYTE,
+  COST_STEP, COST_KEEPOUT, COST_ENCIPHER, COST_LAYER, COST_TEXT, COST_DRAW, COST_PIXEL
+};
+
+/** One way of running the watchface */
+typedef struct {
+  int32_t frame_time; /**< Frame time setting, in ms (0 for adaptive) */
+  int32_t mirror; /**< Mirror setting */
+} Scenario;
+
+static const Scenario scenarios[] = {
+  { 100, 0 }, { 50, 0 }, { 33, 0 }, { 0, 0 },
+  { 100, 1 }, { 50, 1 }, { 33, 1 }, { 0, 1 }
+};
+#define SCENARIO_COUNT (sizeof(scenarios) / sizeof(scenarios[0]))
+
+/** What one scenario did, sent back from its process */
+typedef struct {
+  HostCounters counters;
+  uint32_t steps; /**< Game steps (frames) */
+  uint32_t keepout_steps; /**< Ball steps simulated by the keepout solver */
+  uint32_t encipher_calls; /**< PRNG steps */
+  uint64_t elapsed_ms; /**< Virtual time the counters cover */
+} Usage;
+
+static uint32_t hours = 1; /**< How long to play each scenario for (virtual time) */
+static const Scenario *scenario;
+static Usage usage;
+
+/**
+ * Frame time for the adaptive scenario.
+ *
+ * @param game Current game state
+ * @return int32_t ADAPTIVE_NEAR_MS near the paddle the ball is heading for, ADAPTIVE_FAR_MS elsewhere
+ */
+static int32_t adaptive_frame_time(const HostGame *game) {
+  const int16_t quarter = host_screen_width() / 4;
+
+  if ((game->ball_dx < 0 && game->ball.x < quarter) || (game->ball_dx > 0 && game->ball.x > host_screen_width() - quarter)) {
+    return ADAPTIVE_NEAR_MS;
+  }
+  return ADAPTIVE_FAR_MS;
+}
+
+void host_run(void) {
+  uint64_t start_ms, end_ms;
+  int32_t frame_time;
+  HostGame game, start;
+
+  host_start_game(&game);
+  frame_time = scenario->frame_time ? scenario->frame_time : adaptive_frame_time(&game);
+  host_sync_setting(HOST_KEY_FRAME_TIME, frame_time);
+  host_sync_setting(HOST_KEY_MIRROR, scenario->mirror);
+  host_step();
+  host_reset_counters();
+  host_game(&start);
+  start_ms = host_now_ms();
+  end_ms = start_ms + (uint64_t) hours * 3600000;
+  while (host_now_ms() < end_ms && host_step()) {
+    host_game(&game);
+    if (game.failed) {
+      host_game_clear_failed();
+    }
+    if (!scenario->frame_time && adaptive_frame_time(&game) != frame_time) {
+      frame_time = adaptive_frame_time(&game);
+      host_sync_setting(HOST_KEY_FRAME_TIME, frame_time);
+    }
+  }
+  usage.counters = host_counters;
+  usage.steps = game.frame_count - start.frame_count;
+  usage.keepout_steps = game.keepout_steps - start.keepout_steps;
+  usage.encipher_calls = game.encipher_calls - start.encipher_calls;
+  usage.elapsed_ms = host_now_ms() - start_ms;
+}
+
+/**
+ * CPU cycles the watch spent, by the cycles table.
+ */
+static double cycles(const Usage *u) {
+  const HostCounters *c = &u->counters;
+
+  return costs[COST_STEP].value * u->steps
+    + costs[COST_KEEPOUT].value * u->keepout_steps
+    + costs[COST_ENCIPHER].value * u->encipher_calls
+    + costs[COST_LAYER].value * c->layers_drawn
+    + costs[COST_TEXT].value * c->text_drawn
+    + costs[COST_DRAW].value * c->draw_calls
+    + costs[COST_PIXEL].value * c->pixels_drawn;
+}
+
+/**
+ * Price what the watch did, as mAh per day. The watch marks its whole layer
+ * dirty on each frame, so each redraw sends the whole screen.
+ */
+static double mah_per_day(const Usage *u) {
+  const HostCounters *c = &u->counters;
+  double uc = costs[COST_IDLE].value * u->elapsed_ms / 1000.0
+    + costs[COST_WAKEUP].value * (c->timer_wakeups + c->animation_wakeups + c->tick_wakeups)
+    + costs[COST_MCYCLE].value * cycles(u) / 1e6
+    + costs[COST_ROW].value * c->renders * host_screen_height()
+    + costs[COST_MESSAGE].value * c->messages_sent
+    + costs[COST_BYTE].value * c->message_bytes;
+
+  return uc / UC_PER_MAH * (86400000.0 / u->elapsed_ms);
+}
+
+static int set_cost(const char *arg) {
+  const char *equals = strchr(arg, '=');
+  uint8_t i;
+
+  for (i = 0; equals && i < COST_COUNT; i++) {
+    if (strlen(costs[i].name) == (size_t) (equals - arg) && !strncmp(costs[i].name, arg, equals - arg)) {
+      costs[i].value = atof(equals + 1);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static void list_costs(void) {
+  uint8_t i;
+
+  for (i = 0; i < COST_COUNT; i++) {
+    printf("  %-8s %8g %s  %s\n", costs[i].name, costs[i].value, costs[i].unit, costs[i].what);
+  }
+}
+
+int main(int argc, char **argv) {
+  const Scenario *s;
+  HostCounters *c;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "t:c:l")) != -1) {
+    switch (opt) {
+      case 't':
+        hours = atoi(optarg);
+        break;
+      case 'c':
+        if (!set_cost(optarg)) {
+          fprintf(stderr, "bad cost: %s\n", optarg);
+          return 2;
+        }
+        break;
+      case 'l':
+        list_costs();
+        return 0;
+      default:
+        fprintf(stderr, "usage: %s [-t hours] [-c name=value]... [-l]\n", argv[0]);
+        return 2;
+    }
+  }
+  if (hours < 1) {
+    fprintf(stderr, "hours must be at least 1\n");
+    return 2;
+  }
+
+  printf("%s %dx%d, %u h per scenario, with these costs:\n", HOST_PLATFORM, host_screen_width(), host_screen_height(), hours);
+  list_costs();
+  printf("frame   mirror  ms/frame  wakeups/frame  keepout/frame  encipher/frame  draws/frame  kcycles/frame  messages/min  mAh/day\n");
+  for (s = scenarios; s < scenarios + SCENARIO_COUNT; s++) {
+    scenario = s;
+    if (!host_launch(&usage, sizeof(usage))) {
+      fprintf(stderr, "scenario %d ms %s failed\n", s->frame_time, s->mirror ? "mirrored" : "unmirrored");
+      return 1;
+    }
+    c = &usage.counters;
+    if (s->frame_time) {
+      printf("%3d ms  ", s->frame_time);
+    } else {
+      printf("adapt   ");
+    }
+    printf("%-6s  %8.1f  %13.2f  %13.2f  %14.3f  %11.2f  %13.1f  %12.1f  %7.1f\n", s->mirror ? "on" : "off",
+      (double) usage.elapsed_ms / usage.steps,
+      (double) (c->timer_wakeups + c->animation_wakeups + c->tick_wakeups) / usage.steps,
+      (double) usage.keepout_steps / usage.steps, (double) usage.encipher_calls / usage.steps,
+      (double) c->draw_calls / usage.steps, cycles(&usage) / usage.steps / 1000,
+      c->messages_sent * 60000.0 / usage.elapsed_ms, mah_per_day(&usage));
+  }
+  return 0;
+}
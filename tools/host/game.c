@@ -0,0 +1,105 @@
+/**
+ * The watchface itself, built for the host harness.
+ *
+ * Including the source (rather than linking it) gives the harness read access
+ * to the game state, which the watchface keeps in file statics.
+ */
+#include "host.h"
+
+// The Makefile points this at an older revision to compare against (with HOST_BASE defined)
+#ifndef GAME_SOURCE
+#define GAME_SOURCE "../../src/pingchrong.c"
+#endif
+
+#define main pingchrong_main
+#include GAME_SOURCE
+#undef main
+
+/**
+ * Copy out the parts of the game state the harness checks.
+ *
+ * @param game Filled in with the current state
+ */
+void host_game(HostGame *game) {
+  memset(game, 0, sizeof(*game));
+  game->ball = ball_pos;
+  game->ball_dx = ball_dx;
+  game->ball_dy = ball_dy;
+  game->left_y = left_side.y;
+  game->right_y = right_side.y;
+  game->failed = failed;
+#ifdef HOST_BASE
+  // Older revisions finish starting up before the first frame
+  game->started = 1;
+#else
+  game->started = startup_stage == STARTUP_DONE;
+  game->frame_count = frame_count;
+  game->keepout_solves = keepout_solves;
+  game->keepout_steps = keepout_steps;
+  game->encipher_calls = encipher_calls;
+#endif
+#ifdef UNOBSTRUCTED_RELAYOUT
+  game->relayout = 1;
+#endif
+}
+
+/**
+ * Let the game carry on after an accidental miss (which freezes it). The miss
+ * is let through on the next frame as if it were on purpose, which serves a
+ * new ball.
+ */
+void host_game_clear_failed(void) {
+  failed = 0;
+  minute_changed = hour_changed = 1;
+}
+
+/**
+ * Play until the startup work is done and the ball is in play.
+ *
+ * @param game Filled in with the state at that point
+ */
+void host_start_game(HostGame *game) {
+  do {
+    host_game(game);
+  } while (!game->started && host_step());
+}
+
+#ifndef HOST_BASE
+/**
+ * Copy out what calculate_keepout() reads, for the batch solver.
+ *
+ * @param table Filled in for the current table
+ * @param dir   Side of the table the ball is heading towards (-1 left, 1 right)
+ */
+void host_keepout_table(KeepoutTable *table, int8_t dir) {
+  const PaddleSide *side = (dir < 0) ? &left_side : &right_side;
+  int16_t x;
+
+  memset(table, 0, sizeof(*table));
+  table->left_paddle_x = geometry.left_paddle_x;
+  table->right_paddle_x = geometry.right_paddle_x;
+  table->paddle_w = PADDLE_W;
+  table->ball_radius = BALL_RADIUS;
+  table->face = side->face;
+  table->dir = side->dir;
+#ifdef PBL_ROUND
+  table->columns = round_columns;
+#else
+  table->columns = 1;
+  table->flat = 1;
+#endif
+  for (x = 0; x < table->columns; x++) {
+    table->wall_top[x] = SIM_WALL_TOP(x);
+    table->wall_bottom[x] = WALL_BOTTOM(x);
+  }
+}
+
+/**
+ * Run the watch's own calculate_keepout(), for checking the batch solver.
+ *
+ * @param dir Side of the table the ball is heading towards (-1 left, 1 right)
+ */
+uint8_t host_calculate_keepout(int8_t dir, float x, float y, float dx, float dy, uint8_t *keepout1, uint8_t *keepout2) {
+  return calculate_keepout((dir < 0) ? &left_side : &right_side, x, y, dx, dy, keepout1, keepout2);
+}
+#endif
@@ -0,0 +1,99 @@
+/**
+ * Host harness for the PingChrong watchface.
+ *
+ * Runs src/pingchrong.c on the desktop against the stub SDK in pebble.h. Time
+ * is virtual: it only moves when the harness delivers the next event (a timer,
+ * an animation frame or a minute tick), so runs are repeatable and a day of
+ * play takes seconds. Each tool defines host_run(), which is called from the
+ * watchface's app_event_loop() and drives the game with host_step().
+ */
+#ifndef HOST_H
+#define HOST_H
+
+#include <pebble.h>
+#include "keepout_batch.h"
+
+// Platform the tools were built for (the Makefile passes PLATFORM)
+#ifndef HOST_PLATFORM
+#define HOST_PLATFORM "sdk2"
+#endif
+
+// AppSync keys of the settings, and the AppMessage key of mirror keyframes (see appinfo.json)
+#define HOST_KEY_12H_TIME 0
+#define HOST_KEY_INVERTED 1
+#define HOST_KEY_MIRROR 2
+#define HOST_KEY_KEYFRAME 3
+#define HOST_KEY_BALL_SPEED 4
+#define HOST_KEY_PADDLE_SIZE 5
+#define HOST_KEY_PADDLE_SPEED 6
+#define HOST_KEY_FRAME_TIME 7
+
+// Height of the area a timeline peek covers
+#define HOST_PEEK_HEIGHT 51
+
+/** Counts of what the watch would have done, since the last host_reset_counters() */
+typedef struct {
+  uint32_t timer_wakeups; /**< AppTimer callbacks delivered */
+  uint32_t animation_wakeups; /**< Animation updates delivered */
+  uint32_t tick_wakeups; /**< Tick timer service (minute) callbacks delivered */
+  uint32_t dirty_marks; /**< layer_mark_dirty() calls */
+  uint32_t renders; /**< Times the window was redrawn */
+  uint32_t layers_drawn; /**< Layers drawn during those redraws (update procs run and text layers) */
+  uint32_t text_drawn; /**< Text layers drawn during those redraws */
+  uint64_t draw_calls; /**< graphics_* fill and draw calls */
+  uint64_t pixels_drawn; /**< Pixels written by graphics_* calls */
+  uint64_t rows_changed; /**< Display rows that differ from the previous redraw */
+  uint32_t messages_sent; /**< AppMessages sent to the phone */
+  uint32_t message_bytes; /**< Size of those messages, as AppMessage dictionaries */
+  uint32_t messages_refused; /**< app_message_outbox_begin() calls turned away because a message was still on its way */
+} HostCounters;
+
+/** Game state exposed by game.c */
+typedef struct {
+  GPoint ball; /**< Position of ball's center */
+  float ball_dx, ball_dy; /**< Vector of ball */
+  int16_t left_y, right_y; /**< Positions of the paddles */
+  uint8_t failed; /**< The AI hit the ball when it should have missed (DEBUGGING builds only) */
+  uint8_t started; /**< Startup work is done and the ball is in play */
+  uint32_t frame_count; /**< Animation frames drawn so far */
+  uint32_t keepout_solves; /**< Keepout solves so far (DEBUGGING builds only) */
+  uint32_t keepout_steps; /**< Ball steps simulated by those solves (DEBUGGING builds only) */
+  uint32_t encipher_calls; /**< PRNG steps so far (DEBUGGING builds only) */
+  uint8_t relayout; /**< The table is fitted to the unobstructed area of the screen */
+} HostGame;
+
+/** Called whenever an AppMessage from the watchface reaches the phone */
+typedef void (*HostMessageHandler)(uint32_t key, const uint8_t *data, uint16_t length);
+
+extern HostCounters host_counters;
+extern int host_verbose; /**< Print APP_LOG output */
+extern int host_rasterize; /**< Draw for real (clear it to time the game alone; pixel and row counts stop) */
+extern uint16_t host_timer_latency_ms; /**< Timers and animation updates fire up to this much late (uniformly at random) */
+extern uint16_t host_animation_interval_ms; /**< Time between animation updates */
+extern uint16_t host_outbox_latency_ms; /**< AppMessages reach the phone this much after they are sent (the outbox is busy until then) */
+extern uint16_t host_outbox_busy_ms; /**< Length of a busy period, when AppMessages wait for the phone (none if 0) */
+extern uint32_t host_outbox_busy_period_ms; /**< One busy period starts at a random time in each period this long */
+extern struct timespec host_launched; /**< When host_launch() started the watchface (CLOCK_MONOTONIC) */
+
+// pebble_stubs.c
+void host_run(void);
+uint8_t host_step(void);
+uint64_t host_now_ms(void);
+void host_reset_counters(void);
+void host_set_unobstructed_height(int16_t h);
+void host_sync_setting(uint32_t key, int32_t value);
+void host_set_message_handler(HostMessageHandler handler);
+uint8_t host_app_message_open(void);
+int16_t host_screen_width(void);
+int16_t host_screen_height(void);
+uint8_t host_launch(void *result, size_t size);
+
+// game.c
+int pingchrong_main(void);
+void host_game(HostGame *game);
+void host_game_clear_failed(void);
+void host_start_game(HostGame *game);
+void host_keepout_table(KeepoutTable *table, int8_t dir);
+uint8_t host_calculate_keepout(int8_t dir, float x, float y, float dx, float dy, uint8_t *keepout1, uint8_t *keepout2);
+
+#endif /* HOST_H */
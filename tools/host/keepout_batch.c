@@ -0,0 +1,262 @@
+/**
+ * Batch keepout solver; see keepout_batch.h.
+ *
+ * The scalar solver is the watch's own keepout_solve() (src/keepout.h). The
+ * vector solver does the same float operations in the same order so the
+ * answers match it exactly: no reassociation or fused multiply-adds (the
+ * Makefile builds this file with -ffp-contract=off), and the float to uint8_t
+ * conversions truncate through int32_t, as the host build of the watch code
+ * does. (A ball that bounces off a wall beyond the screen's edge converts out
+ * of range, which C leaves undefined; the watch itself may saturate there
+ * instead.)
+ */
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#include "keepout_batch.h"
+
+/**
+ * Column of the walls the ball is in (WALL_COLUMN() in src/pingchrong.c).
+ *
+ * @param x Horizontal position of ball
+ */
+static int16_t wall_column(const KeepoutTable *table, float x) {
+  return x < 0 ? 0 : (x >= table->columns ? table->columns - 1 : (int) x);
+}
+
+/** The walls as the scalar solver reads them; flat is a constant in each copy of solve_balls() */
+typedef struct {
+  const KeepoutTable *table;
+  uint8_t flat; /**< The walls are straight, so there is nothing to look up */
+  int16_t top, bottom; /**< The straight walls */
+} Walls;
+
+#define KEEPOUT_WALLS Walls
+#define KEEPOUT_WALL_TOP(walls, x) ((walls)->flat ? (walls)->top : (walls)->table->wall_top[wall_column((walls)->table, x)])
+#define KEEPOUT_WALL_BOTTOM(walls, x) ((walls)->flat ? (walls)->bottom : (walls)->table->wall_bottom[wall_column((walls)->table, x)])
+#include "../../src/keepout.h"
+
+/**
+ * Solve every ball in the batch one at a time, with the watch's own solver.
+ *
+ * @param flat table->flat, as a constant so the compiler drops the lookups it does not need
+ */
+static inline __attribute__((always_inline)) void solve_balls(const KeepoutTable *table, KeepoutBatch *batch, uint8_t flat) {
+  const Walls walls = { table, flat, table->wall_top[0], table->wall_bottom[0] };
+  const int16_t right_x = table->right_paddle_x + table->paddle_w;
+  uint32_t i;
+
+  for (i = 0; i < batch->count; i++) {
+    batch->ticks[i] = keepout_solve(&walls, table->left_paddle_x, right_x, table->ball_radius, table->face, table->dir,
+      batch->x[i], batch->y[i], batch->dx[i], batch->dy[i], &batch->keepout1[i], &batch->keepout2[i]);
+  }
+}
+
+/**
+ * Solve every ball in the batch one at a time.
+ */
+void keepout_batch_scalar(const KeepoutTable *table, KeepoutBatch *batch) {
+  if (table->flat) {
+    solve_balls(table, batch, 1);
+  } else {
+    solve_balls(table, batch, 0);
+  }
+}
+
+// Vectors need GCC 10 or clang (define KEEPOUT_BATCH_SCALAR to try the fallback anyway)
+#ifdef __has_builtin
+#if __has_builtin(__builtin_convertvector) && !defined(KEEPOUT_BATCH_SCALAR)
+#define KEEPOUT_VECTORS
+#endif
+#endif
+
+#ifdef KEEPOUT_VECTORS
+// As many lanes as the widest vectors the compiler was told it may use (the Makefile builds for the host's CPU)
+#if defined(__AVX512F__)
+#define KEEPOUT_LANES 16
+#elif defined(__AVX__)
+#define KEEPOUT_LANES 8
+#else
+#define KEEPOUT_LANES 4
+#endif
+
+typedef float Floats __attribute__((vector_size(KEEPOUT_LANES * sizeof(float))));
+typedef int32_t Ints __attribute__((vector_size(KEEPOUT_LANES * sizeof(int32_t))));
+
+/**
+ * Pick each lane from a where mask is set and from b where it is clear.
+ *
+ * @param mask All ones or all zeros in each lane, as vector comparisons give
+ */
+static inline Floats select_floats(Ints mask, Floats a, Floats b) {
+  return (Floats) (((Ints) a & mask) | ((Ints) b & ~mask));
+}
+
+static inline Ints select_ints(Ints mask, Ints a, Ints b) {
+  return (a & mask) | (b & ~mask);
+}
+
+static inline int any_lane(Ints mask) {
+  uint8_t lane;
+
+  for (lane = 0; lane < KEEPOUT_LANES; lane++) {
+    if (mask[lane]) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Column of the walls each lane's ball is in, as wall_column() works it out.
+ */
+static inline Ints wall_columns(const KeepoutTable *table, Floats x) {
+  const Ints last = (Ints) {} + (table->columns - 1);
+  Ints column = __builtin_convertvector(x, Ints);
+
+  column = select_ints(x >= (Floats) {} + (float) table->columns, last, column);
+  return select_ints(x < (Floats) {}, (Ints) {}, column);
+}
+
+/**
+ * Look up a wall for each lane (a gather; round walls differ by column).
+ *
+ * The gather instructions load four bytes from each column and keep the
+ * first, which stays inside the table: columns are at most TABLE_WIDTH, well
+ * short of KEEPOUT_MAX_COLUMNS. Without them, the vector is built from
+ * scalars rather than written lane by lane, which stalls on reading it back.
+ */
+static inline Floats wall_at(const uint8_t *wall, Ints column) {
+#if KEEPOUT_LANES == 16
+  Ints walls = (Ints) _mm512_i32gather_epi32((__m512i) column, wall, 1) & 0xff;
+#elif KEEPOUT_LANES == 8 && defined(__AVX2__)
+  Ints walls = (Ints) _mm256_i32gather_epi32((const int *) wall, (__m256i) column, 1) & 0xff;
+#elif KEEPOUT_LANES == 8
+  Ints walls = { wall[column[0]], wall[column[1]], wall[column[2]], wall[column[3]],
+    wall[column[4]], wall[column[5]], wall[column[6]], wall[column[7]] };
+#else
+  Ints walls = { wall[column[0]], wall[column[1]], wall[column[2]], wall[column[3]] };
+#endif
+  return __builtin_convertvector(walls, Floats);
+}
+
+/** Balls in flight in the lanes, and where the next one comes from */
+typedef struct {
+  Floats x, y, dx, dy, keepout1;
+  Ints active, collided, tix;
+  uint32_t ball[KEEPOUT_LANES]; /**< Index in the batch of the ball in each lane */
+  uint32_t next; /**< Index of the next ball to load */
+} Lanes;
+
+/**
+ * Give a lane the next ball that needs simulating, or leave it idle when
+ * there are none left. Balls that start past a paddle are answered here.
+ */
+static void load_lane(const KeepoutTable *table, KeepoutBatch *batch, Lanes *lanes, uint8_t lane) {
+  uint32_t i;
+
+  lanes->active[lane] = 0;
+  while (lanes->next < batch->count) {
+    i = lanes->next++;
+    if (((batch->x[i] + table->ball_radius + 1) < (table->right_paddle_x + table->paddle_w)) && ((batch->x[i] + table->ball_radius) > table->left_paddle_x)) {
+      lanes->ball[lane] = i;
+      lanes->x[lane] = batch->x[i];
+      lanes->y[lane] = batch->y[i];
+      lanes->dx[lane] = batch->dx[i];
+      lanes->dy[lane] = batch->dy[i];
+      lanes->collided[lane] = 0;
+      lanes->tix[lane] = 0;
+      lanes->active[lane] = -1;
+      return;
+    }
+    batch->keepout2[i] = (int32_t) batch->y[i];
+    batch->ticks[i] = 0;
+  }
+  // idle: stay put
+  lanes->dx[lane] = lanes->dy[lane] = 0;
+}
+
+/**
+ * Write out the answer for the ball in a lane that has passed the paddle.
+ */
+static void finish_lane(KeepoutBatch *batch, const Lanes *lanes, uint8_t lane) {
+  uint32_t i = lanes->ball[lane];
+
+  batch->ticks[i] = lanes->tix[lane];
+  if (lanes->collided[lane]) {
+    batch->keepout1[i] = (int32_t) lanes->keepout1[lane];
+  }
+  batch->keepout2[i] = (int32_t) lanes->y[lane];
+}
+
+/**
+ * Solve every ball in the batch, KEEPOUT_LANES side by side. A lane whose
+ * ball has passed the paddle takes the next ball straight away, so short
+ * rallies do not wait for long ones.
+ */
+void keepout_batch(const KeepoutTable *table, KeepoutBatch *batch) {
+  const Floats left = (Floats) {} + (float) table->left_paddle_x;
+  const Floats right = (Floats) {} + (float) (table->right_paddle_x + table->paddle_w);
+  const Floats radius = (Floats) {} + (float) table->ball_radius;
+  const Floats face = (Floats) {} + (float) table->face;
+  const Floats dir = (Floats) {} + (float) table->dir;
+  const Floats flat_bottom = (Floats) {} + (float) table->wall_bottom[0];
+  const Floats flat_top = (Floats) {} + (float) table->wall_top[0];
+  Lanes lanes = { .next = 0 };
+  Floats old_x, old_y, wall, hit_dx;
+  Ints column = {}, hit, done;
+  uint8_t lane;
+
+  for (lane = 0; lane < KEEPOUT_LANES; lane++) {
+    load_lane(table, batch, &lanes, lane);
+  }
+  while (any_lane(lanes.active)) {
+    old_x = lanes.x;
+    old_y = lanes.y;
+    lanes.y += lanes.dy;
+    lanes.x += lanes.dx;
+
+    if (!table->flat) {
+      column = wall_columns(table, lanes.x);
+    }
+    wall = table->flat ? flat_bottom : wall_at(table->wall_bottom, column);
+    hit = lanes.y > wall;
+    lanes.y = select_floats(hit, wall, lanes.y);
+    lanes.dy = select_floats(hit, -lanes.dy, lanes.dy);
+
+    wall = table->flat ? flat_top : wall_at(table->wall_top, column);
+    hit = lanes.y < wall;
+    lanes.y = select_floats(hit, wall, lanes.y);
+    lanes.dy = select_floats(hit, -lanes.dy, lanes.dy);
+
+    hit = ~lanes.collided & ((lanes.x - face) * dir >= 0);
+    hit_dx = face - old_x;
+    lanes.keepout1 = select_floats(hit, old_y + (hit_dx / lanes.dx) * lanes.dy, lanes.keepout1);
+    lanes.collided |= hit;
+    lanes.tix -= ~lanes.collided;
+
+    done = lanes.active & ~(((lanes.x + radius + 1) < right) & ((lanes.x + radius) > left));
+    if (any_lane(done)) {
+      for (lane = 0; lane < KEEPOUT_LANES; lane++) {
+        if (done[lane]) {
+          finish_lane(batch, &lanes, lane);
+          load_lane(table, batch, &lanes, lane);
+        }
+      }
+    }
+  }
+}
+#else
+#define KEEPOUT_LANES 1
+
+void keepout_batch(const KeepoutTable *table, KeepoutBatch *batch) {
+  keepout_batch_scalar(table, batch);
+}
+#endif
+
+/**
+ * How many balls keepout_batch() solves side by side (1 for the scalar fallback).
+ */
+uint8_t keepout_batch_lanes(void) {
+  return KEEPOUT_LANES;
+}
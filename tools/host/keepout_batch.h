@@ -0,0 +1,52 @@
+/**
+ * Batch keepout solver: calculate_keepout() from src/pingchrong.c for many
+ * balls at once, to sweep initial conditions on the host.
+ *
+ * The balls are held as a structure of arrays. keepout_batch() runs them in
+ * SIMD lanes (GCC and clang vector extensions, as wide as the host's vectors)
+ * where the compiler has them and falls back to keepout_batch_scalar() where
+ * it does not. The scalar solver is the watch's own core (src/keepout.h), and
+ * the vector one gives bit-for-bit the same answers for each ball (the batch
+ * tool checks).
+ *
+ * Only the keepout solver is batched, not the rest of the game step: where
+ * the ball and paddles go next depends on each game's clock (the misses that
+ * keep the time), its paddle plans and its PRNG, so the games in a batch
+ * would branch apart on every frame and the lanes would mostly idle. Sweeps
+ * of rallies need only the solver: a rally is a serve and one solve per
+ * paddle.
+ */
+#ifndef KEEPOUT_BATCH_H
+#define KEEPOUT_BATCH_H
+
+#include <stdint.h>
+
+#define KEEPOUT_MAX_COLUMNS 256
+
+/** What calculate_keepout() reads from the table and the paddle the ball is heading towards */
+typedef struct {
+  int16_t left_paddle_x, right_paddle_x; /**< Horizontal positions of the paddles */
+  int16_t paddle_w, ball_radius; /**< PADDLE_W and BALL_RADIUS */
+  int16_t face; /**< Horizontal position of the ball's center when it touches the paddle */
+  int8_t dir; /**< Sign of the ball's horizontal vector when it is heading towards the paddle */
+  int16_t columns; /**< Columns of the walls below (only the first is used when flat) */
+  uint8_t flat; /**< The walls are straight (rectangular screens) */
+  uint8_t wall_top[KEEPOUT_MAX_COLUMNS]; /**< Highest the ball's center goes, in the simulation, for each column */
+  uint8_t wall_bottom[KEEPOUT_MAX_COLUMNS]; /**< Lowest the ball's center goes, for each column */
+} KeepoutTable;
+
+/** Balls to solve for, and their answers; every array holds count entries */
+typedef struct {
+  uint32_t count;
+  const float *x, *y; /**< Position of each ball */
+  const float *dx, *dy; /**< Vector of each ball */
+  uint8_t *ticks; /**< Set to the frames until each ball reaches the paddle */
+  uint8_t *keepout1; /**< Set to each ball's vertical position when it reaches the paddle */
+  uint8_t *keepout2; /**< Set to each ball's vertical position when it has passed the paddle */
+} KeepoutBatch;
+
+void keepout_batch(const KeepoutTable *table, KeepoutBatch *batch);
+void keepout_batch_scalar(const KeepoutTable *table, KeepoutBatch *batch);
+uint8_t keepout_batch_lanes(void);
+
+#endif /* KEEPOUT_BATCH_H */
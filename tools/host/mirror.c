@@ -0,0 +1,117 @@
+/**
+ * Record the keyframes the watchface streams to the phone, along with where
+ * the ball and paddles really were on every frame, for the mock in tools/js.
+ *
+ * Usage: mirror [-t minutes] [-p seconds] [-l ms] [-b ms] [-s key=value]... > mirror.txt
+ *
+ * With -p, the bottom of the screen is covered and uncovered (as a timeline
+ * peek does) every so many seconds. With -l, AppMessages take that long to
+ * reach the phone, and with -b the phone is busy for that long once a minute
+ * (at a random time), holding up any message that would arrive meanwhile; the
+ * outbox is busy until the phone has the message.
+ *
+ * Output is one line per event:
+ *   T <frame time in ms>
+ *   K <frame> <keyframe bytes, in hex>
+ *   F <frame> <ball x> <ball y> <left paddle y> <right paddle y>
+ *   R <keyframes turned away by a busy outbox>  (last)
+ * A keyframe comes before the first frame drawn after it reached the phone
+ * (without -l or -b, that is the frame it was sent during).
+ */
+#include <getopt.h>
+#include "host.h"
+
+#define MAX_SETTINGS 8
+
+static uint32_t minutes = 60; /**< How long to play for (virtual time) */
+static uint32_t peek_interval_ms; /**< Time between covering and uncovering the screen */
+static uint32_t setting_keys[MAX_SETTINGS];
+static int32_t setting_values[MAX_SETTINGS];
+static uint8_t setting_count;
+static int32_t frame_time = 50;
+
+static void print_keyframe(uint32_t key, const uint8_t *data, uint16_t length) {
+  uint32_t frame = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t) data[3] << 24);
+  uint16_t i;
+
+  if (key != HOST_KEY_KEYFRAME) {
+    return;
+  }
+  printf("K %u ", frame);
+  for (i = 0; i < length; i++) {
+    printf("%02x", data[i]);
+  }
+  printf("\n");
+}
+
+void host_run(void) {
+  const uint64_t end_ms = (uint64_t) minutes * 60000;
+  uint32_t last_frame = 0;
+  uint64_t next_peek_ms = peek_interval_ms;
+  uint8_t settings_sent = 0, peeking = 0;
+  HostGame game;
+  uint8_t i;
+
+  host_set_message_handler(print_keyframe);
+  printf("T %d\n", frame_time);
+  while (host_now_ms() < end_ms && host_step()) {
+    host_game(&game);
+    if (game.started && !settings_sent) {
+      host_sync_setting(HOST_KEY_MIRROR, 1);
+      for (i = 0; i < setting_count; i++) {
+        host_sync_setting(setting_keys[i], setting_values[i]);
+      }
+      settings_sent = 1;
+    }
+    if (game.failed) {
+      host_game_clear_failed();
+    }
+    if (peek_interval_ms && host_now_ms() >= next_peek_ms) {
+      peeking = !peeking;
+      host_set_unobstructed_height(host_screen_height() - (peeking ? HOST_PEEK_HEIGHT : 0));
+      next_peek_ms += peek_interval_ms;
+    }
+    if (game.frame_count != last_frame) {
+      printf("F %u %d %d %d %d\n", game.frame_count, game.ball.x, game.ball.y, game.left_y, game.right_y);
+      last_frame = game.frame_count;
+    }
+  }
+  printf("R %u\n", host_counters.messages_refused);
+}
+
+int main(int argc, char **argv) {
+  int opt;
+
+  while ((opt = getopt(argc, argv, "t:p:l:b:s:")) != -1) {
+    switch (opt) {
+      case 't':
+        minutes = atoi(optarg);
+        break;
+      case 'p':
+        peek_interval_ms = atoi(optarg) * 1000;
+        break;
+      case 'l':
+        host_outbox_latency_ms = atoi(optarg);
+        break;
+      case 'b':
+        host_outbox_busy_ms = atoi(optarg);
+        break;
+      case 's':
+        if (setting_count == MAX_SETTINGS || sscanf(optarg, "%u=%d", &setting_keys[setting_count], &setting_values[setting_count]) != 2) {
+          fprintf(stderr, "bad setting: %s\n", optarg);
+          return 2;
+        }
+        if (setting_keys[setting_count] == HOST_KEY_FRAME_TIME) {
+          frame_time = setting_values[setting_count];
+        }
+        setting_count++;
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-t minutes] [-p seconds] [-l ms] [-b ms] [-s key=value]...\n", argv[0]);
+        return 2;
+    }
+  }
+
+  pingchrong_main();
+  return 0;
+}
@@ -0,0 +1,185 @@
+/**
+ * Stub of the parts of the Pebble SDK used by PingChrong, for host builds.
+ *
+ * Declarations follow the SDK's names and signatures closely enough that
+ * src/pingchrong.c compiles unchanged; the implementations (and the virtual
+ * clock, display and phone behind them) live in pebble_stubs.c.
+ */
+#ifndef HOST_PEBBLE_H
+#define HOST_PEBBLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Only SDK 3 has the API existence checks
+#ifdef PBL_SDK_3
+#define PBL_API_EXISTS(x) 1
+#endif
+
+// Geometry
+typedef struct { int16_t x, y; } GPoint;
+typedef struct { int16_t w, h; } GSize;
+typedef struct { GPoint origin; GSize size; } GRect;
+#define GPoint(x, y) ((GPoint) {(x), (y)})
+#define GSize(w, h) ((GSize) {(w), (h)})
+#define GRect(x, y, w, h) ((GRect) {{(x), (y)}, {(w), (h)}})
+
+typedef enum { GColorBlack, GColorWhite, GColorClear } GColor;
+typedef enum { GCornerNone = 0, GCornersAll = 0xF } GCornerMask;
+typedef enum { GTextAlignmentLeft, GTextAlignmentCenter, GTextAlignmentRight } GTextAlignment;
+typedef enum { GOvalScaleModeFitCircle, GOvalScaleModeFillCircle } GOvalScaleMode;
+
+// Trigonometry
+#define TRIG_MAX_RATIO 0xffff
+#define TRIG_MAX_ANGLE 0x10000
+#define DEG_TO_TRIGANGLE(angle) (((angle) * TRIG_MAX_ANGLE) / 360)
+int32_t sin_lookup(int32_t angle);
+int32_t cos_lookup(int32_t angle);
+int32_t atan2_lookup(int16_t y, int16_t x);
+
+// Logging (printed only when the harness runs verbosely)
+#define APP_LOG_LEVEL_ERROR 1
+#define APP_LOG_LEVEL_WARNING 50
+#define APP_LOG_LEVEL_INFO 100
+#define APP_LOG_LEVEL_DEBUG 200
+void app_log(uint8_t level, const char *filename, int line, const char *fmt, ...);
+#define APP_LOG(level, ...) app_log(level, __FILE__, __LINE__, __VA_ARGS__)
+
+// Time
+typedef enum { SECOND_UNIT = 1 << 0, MINUTE_UNIT = 1 << 1, HOUR_UNIT = 1 << 2, DAY_UNIT = 1 << 3 } TimeUnits;
+typedef void (*TickHandler)(struct tm *tick_time, TimeUnits units_changed);
+time_t host_time(time_t *t);
+#define time host_time
+uint16_t time_ms(time_t *t, uint16_t *out_ms);
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler);
+void tick_timer_service_unsubscribe(void);
+
+// Layers and drawing
+typedef struct Layer Layer;
+typedef struct TextLayer TextLayer;
+typedef struct Window Window;
+typedef struct GContext GContext;
+typedef void (*LayerUpdateProc)(Layer *layer, GContext *ctx);
+
+Layer *layer_create(GRect frame);
+void layer_destroy(Layer *layer);
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc);
+void layer_add_child(Layer *parent, Layer *child);
+void layer_mark_dirty(Layer *layer);
+void layer_set_frame(Layer *layer, GRect frame);
+GRect layer_get_bounds(const Layer *layer);
+GRect layer_get_unobstructed_bounds(const Layer *layer);
+
+TextLayer *text_layer_create(GRect frame);
+void text_layer_destroy(TextLayer *text_layer);
+Layer *text_layer_get_layer(TextLayer *text_layer);
+void text_layer_set_text(TextLayer *text_layer, const char *text);
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment);
+void text_layer_set_background_color(TextLayer *text_layer, GColor color);
+void text_layer_set_text_color(TextLayer *text_layer, GColor color);
+
+void graphics_context_set_fill_color(GContext *ctx, GColor color);
+void graphics_context_set_stroke_color(GContext *ctx, GColor color);
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask);
+void graphics_draw_rect(GContext *ctx, GRect rect);
+void graphics_fill_circle(GContext *ctx, GPoint p, uint16_t radius);
+void graphics_fill_radial(GContext *ctx, GRect rect, GOvalScaleMode scale_mode, uint16_t inset_thickness, int32_t angle_start, int32_t angle_end);
+
+// Windows
+typedef void (*WindowHandler)(Window *window);
+typedef struct {
+  WindowHandler load;
+  WindowHandler appear;
+  WindowHandler disappear;
+  WindowHandler unload;
+} WindowHandlers;
+Window *window_create(void);
+void window_destroy(Window *window);
+void window_set_window_handlers(Window *window, WindowHandlers handlers);
+void window_set_background_color(Window *window, GColor background_color);
+Layer *window_get_root_layer(const Window *window);
+void window_stack_push(Window *window, bool animated);
+
+// Timers and animations
+typedef struct AppTimer AppTimer;
+typedef void (*AppTimerCallback)(void *data);
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data);
+void app_timer_cancel(AppTimer *timer);
+
+typedef struct Animation Animation;
+#ifdef PBL_SDK_3
+typedef int32_t AnimationProgress;
+#define ANIMATION_NORMALIZED_MAX 65535
+typedef void (*AnimationUpdateImplementation)(Animation *animation, const AnimationProgress progress);
+#else
+typedef void (*AnimationUpdateImplementation)(Animation *animation, const uint32_t time_normalized);
+#endif
+typedef struct {
+  void (*setup)(Animation *animation);
+  AnimationUpdateImplementation update;
+  void (*teardown)(Animation *animation);
+} AnimationImplementation;
+#define ANIMATION_DURATION_INFINITE ((uint32_t) ~0)
+Animation *animation_create(void);
+void animation_destroy(Animation *animation);
+void animation_set_implementation(Animation *animation, const AnimationImplementation *implementation);
+void animation_set_duration(Animation *animation, uint32_t duration_ms);
+void animation_schedule(Animation *animation);
+void animation_unschedule(Animation *animation);
+
+#ifdef PBL_SDK_3
+typedef void (*UnobstructedAreaWillChangeHandler)(GRect final_unobstructed_screen_area, void *context);
+typedef void (*UnobstructedAreaChangeHandler)(AnimationProgress progress, void *context);
+typedef void (*UnobstructedAreaDidChangeHandler)(void *context);
+typedef struct {
+  UnobstructedAreaWillChangeHandler will_change;
+  UnobstructedAreaChangeHandler change;
+  UnobstructedAreaDidChangeHandler did_change;
+} UnobstructedAreaHandlers;
+void unobstructed_area_service_subscribe(UnobstructedAreaHandlers handlers, void *context);
+void unobstructed_area_service_unsubscribe(void);
+#endif
+
+// Messaging
+typedef enum { DICT_OK = 0, DICT_NOT_ENOUGH_STORAGE = 1 << 1 } DictionaryResult;
+typedef enum { APP_MSG_OK = 0, APP_MSG_BUSY = 1 << 10 } AppMessageResult;
+typedef struct DictionaryIterator DictionaryIterator;
+typedef struct {
+  uint32_t key;
+  uint8_t type;
+  uint16_t length;
+  union {
+    uint8_t data[0];
+    uint8_t uint8;
+    uint16_t uint16;
+    uint32_t uint32;
+    int8_t int8;
+    int16_t int16;
+    int32_t int32;
+  } value[];
+} Tuple;
+typedef struct {
+  uint32_t key;
+  int32_t integer;
+} Tuplet;
+#define TupletInteger(_key, _integer) ((const Tuplet) { .key = (_key), .integer = (_integer) })
+typedef void (*AppSyncTupleChangedCallback)(const uint32_t key, const Tuple *new_tuple, const Tuple *old_tuple, void *context);
+typedef void (*AppSyncErrorCallback)(DictionaryResult dict_error, AppMessageResult app_message_error, void *context);
+typedef struct { uint8_t unused; } AppSync;
+void app_sync_init(AppSync *s, uint8_t *buffer, const uint16_t buffer_size, const Tuplet * const keys_and_initial_values, const uint8_t count,
+  AppSyncTupleChangedCallback tuple_changed_callback, AppSyncErrorCallback error_callback, void *context);
+void app_sync_deinit(AppSync *s);
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound);
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator);
+AppMessageResult app_message_outbox_send(void);
+DictionaryResult dict_write_data(DictionaryIterator *iter, const uint32_t key, const uint8_t * const data, const uint16_t size);
+
+// App lifecycle
+#define ARRAY_LENGTH(array) (sizeof((array)) / sizeof((array)[0]))
+void app_event_loop(void);
+
+#endif /* HOST_PEBBLE_H */
@@ -0,0 +1,805 @@
+/**
+ * Stub Pebble SDK for host builds: a virtual clock, an event loop, a 1-bit
+ * display and a phone that accepts every AppMessage (after a delay, if the
+ * harness asks for one).
+ *
+ * The display is rasterized for real, so the harness can count pixels drawn
+ * and display rows that change from one redraw to the next.
+ */
+#include <math.h>
+#include <stdarg.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "host.h"
+
+#ifndef HOST_SCREEN_W
+#define HOST_SCREEN_W 144
+#define HOST_SCREEN_H 168
+#endif
+
+// Virtual time starts at 2026-01-01 00:00:00 (UTC)
+#define HOST_EPOCH 1767225600
+
+#define MAX_CHILDREN 8
+#define MAX_TIMERS 8
+#define MAX_ANIMATIONS 4
+#define MAX_TUPLES 8
+
+struct Layer {
+  GRect frame;
+  LayerUpdateProc update_proc;
+  Layer *children[MAX_CHILDREN];
+  uint8_t child_count;
+  bool text; /**< A text layer (the stub does not draw its text) */
+};
+
+struct TextLayer {
+  Layer layer;
+  const char *text;
+};
+
+struct Window {
+  Layer root;
+  WindowHandlers handlers;
+  GColor background;
+  bool loaded;
+};
+
+struct GContext {
+  GColor fill;
+  GColor stroke;
+  GPoint offset;
+};
+
+struct AppTimer {
+  uint64_t due;
+  AppTimerCallback callback;
+  void *data;
+  bool active;
+};
+
+struct Animation {
+  const AnimationImplementation *implementation;
+  uint64_t next; /**< When the next update is scheduled */
+  uint64_t due; /**< When it is delivered (later, by the latency) */
+  bool used;
+  bool scheduled;
+};
+
+struct DictionaryIterator {
+  uint8_t count;
+  uint32_t keys[MAX_TUPLES];
+  uint8_t data[MAX_TUPLES][64];
+  uint16_t lengths[MAX_TUPLES];
+};
+
+HostCounters host_counters;
+int host_verbose;
+int host_rasterize = 1;
+uint16_t host_timer_latency_ms;
+uint16_t host_animation_interval_ms = 33;
+uint16_t host_outbox_latency_ms;
+uint16_t host_outbox_busy_ms;
+uint32_t host_outbox_busy_period_ms = 60000;
+struct timespec host_launched;
+
+static uint64_t now_ms; /**< Virtual time since HOST_EPOCH */
+static uint32_t rand_state = 1; /**< State of the generator behind the latency */
+static bool dirty; /**< The window needs to be redrawn */
+static Window *top_window;
+static uint8_t framebuffer[HOST_SCREEN_H][HOST_SCREEN_W];
+static uint8_t shown[HOST_SCREEN_H][HOST_SCREEN_W]; /**< What the display showed after the previous redraw */
+static struct AppTimer timers[MAX_TIMERS];
+static struct Animation animations[MAX_ANIMATIONS];
+static TickHandler tick_handler;
+static uint64_t next_tick_ms;
+static int16_t unobstructed_h = HOST_SCREEN_H;
+#ifdef PBL_SDK_3
+static UnobstructedAreaHandlers unobstructed_handlers;
+static void *unobstructed_context;
+#endif
+static AppSyncTupleChangedCallback sync_changed;
+static void *sync_context;
+static bool outbox_open;
+static struct DictionaryIterator outbox;
+static struct DictionaryIterator in_flight; /**< The message on its way to the phone */
+static bool sending; /**< A message is on its way, so the outbox is busy */
+static uint64_t in_flight_due; /**< When it reaches the phone (and the outbox frees up) */
+static HostMessageHandler message_handler;
+
+/* ----- Harness ----- */
+
+uint64_t host_now_ms(void) {
+  return now_ms;
+}
+
+int16_t host_screen_width(void) {
+  return HOST_SCREEN_W;
+}
+
+int16_t host_screen_height(void) {
+  return HOST_SCREEN_H;
+}
+
+void host_reset_counters(void) {
+  memset(&host_counters, 0, sizeof(host_counters));
+}
+
+uint8_t host_app_message_open(void) {
+  return outbox_open;
+}
+
+void host_set_message_handler(HostMessageHandler handler) {
+  message_handler = handler;
+}
+
+/**
+ * Run the watchface in a fresh process (it keeps its state in statics) and
+ * copy back what the tool's host_run() left in result.
+ *
+ * @param result Filled in by host_run() in the child, and copied back here
+ * @param size   Size of result
+ * @return uint8_t 0 if the child failed
+ */
+uint8_t host_launch(void *result, size_t size) {
+  int pipe_fds[2];
+  uint8_t ok;
+
+  if (pipe(pipe_fds) || fflush(stdout)) {
+    return 0;
+  }
+  if (fork() == 0) {
+    close(pipe_fds[0]);
+    clock_gettime(CLOCK_MONOTONIC, &host_launched);
+    pingchrong_main();
+    _exit(write(pipe_fds[1], result, size) != (ssize_t) size);
+  }
+  close(pipe_fds[1]);
+  ok = read(pipe_fds[0], result, size) == (ssize_t) size;
+  close(pipe_fds[0]);
+  wait(NULL);
+  return ok;
+}
+
+/**
+ * Deliver a setting as if the phone had sent it through AppSync.
+ */
+void host_sync_setting(uint32_t key, int32_t value) {
+  uint8_t buffer[sizeof(Tuple) + sizeof(int32_t)];
+  Tuple *tuple = (Tuple *) buffer;
+
+  if (!sync_changed) {
+    return;
+  }
+  tuple->key = key;
+  tuple->type = 3;
+  tuple->length = sizeof(int32_t);
+  memcpy(tuple->value, &value, sizeof(value));
+  sync_changed(key, tuple, tuple, sync_context);
+}
+
+/**
+ * Cover (or uncover) the bottom of the screen, as a timeline peek would.
+ */
+void host_set_unobstructed_height(int16_t h) {
+#ifdef PBL_SDK_3
+  GRect area = GRect(0, 0, HOST_SCREEN_W, h);
+  if (unobstructed_handlers.will_change) {
+    unobstructed_handlers.will_change(area, unobstructed_context);
+  }
+  unobstructed_h = h;
+  if (unobstructed_handlers.change) {
+    unobstructed_handlers.change(ANIMATION_NORMALIZED_MAX, unobstructed_context);
+  }
+  if (unobstructed_handlers.did_change) {
+    unobstructed_handlers.did_change(unobstructed_context);
+  }
+#else
+  unobstructed_h = h;
+#endif
+}
+
+static void draw_layer(Layer *layer, GContext *ctx, GPoint offset) {
+  uint8_t i;
+
+  offset.x += layer->frame.origin.x;
+  offset.y += layer->frame.origin.y;
+  if (layer->update_proc || layer->text) {
+    host_counters.layers_drawn++;
+  }
+  if (layer->text) {
+    host_counters.text_drawn++;
+  }
+  if (layer->update_proc) {
+    ctx->offset = offset;
+    layer->update_proc(layer, ctx);
+  }
+  for (i = 0; i < layer->child_count; i++) {
+    draw_layer(layer->children[i], ctx, offset);
+  }
+}
+
+/**
+ * Redraw the window, as the system does after an event marked a layer dirty.
+ */
+static void render(void) {
+  GContext ctx = { .fill = GColorBlack, .stroke = GColorBlack };
+  int16_t y;
+
+  if (!host_rasterize) {
+    draw_layer(&top_window->root, &ctx, GPoint(0, 0));
+    host_counters.renders++;
+    dirty = false;
+    return;
+  }
+  memset(framebuffer, top_window->background == GColorWhite, sizeof(framebuffer));
+  draw_layer(&top_window->root, &ctx, GPoint(0, 0));
+  for (y = 0; y < HOST_SCREEN_H; y++) {
+    if (memcmp(framebuffer[y], shown[y], HOST_SCREEN_W)) {
+      host_counters.rows_changed++;
+    }
+  }
+  memcpy(shown, framebuffer, sizeof(shown));
+  host_counters.renders++;
+  dirty = false;
+}
+
+/**
+ * How late to deliver a timer or animation update: up to host_timer_latency_ms,
+ * uniformly at random.
+ */
+static uint16_t latency(void) {
+  if (!host_timer_latency_ms) {
+    return 0;
+  }
+  rand_state = rand_state * 1103515245 + 12345;
+  return (rand_state >> 16) % (host_timer_latency_ms + 1);
+}
+
+/**
+ * When a message sent at the given time reaches the phone:
+ * host_outbox_latency_ms later, or at the end of the busy period it would
+ * arrive in. One busy period of host_outbox_busy_ms starts at a random time
+ * in each host_outbox_busy_period_ms.
+ *
+ * @param sent_ms When the message was sent
+ * @return uint64_t When it reaches the phone
+ */
+static uint64_t outbox_arrival(uint64_t sent_ms) {
+  uint64_t arrival = sent_ms + host_outbox_latency_ms, period, start;
+
+  if (!host_outbox_busy_ms || host_outbox_busy_ms >= host_outbox_busy_period_ms) {
+    return arrival;
+  }
+  period = arrival / host_outbox_busy_period_ms;
+  start = period * host_outbox_busy_period_ms +
+    (((uint32_t) period * 2654435761u) >> 8) % (host_outbox_busy_period_ms - host_outbox_busy_ms);
+  if (arrival >= start && arrival < start + host_outbox_busy_ms) {
+    return start + host_outbox_busy_ms;
+  }
+  return arrival;
+}
+
+/**
+ * Hand the message in flight to the phone (the harness's message handler).
+ */
+static void deliver_outbox(void) {
+  uint8_t i;
+
+  sending = false;
+  for (i = 0; i < in_flight.count; i++) {
+    if (message_handler) {
+      message_handler(in_flight.keys[i], in_flight.data[i], in_flight.lengths[i]);
+    }
+  }
+}
+
+/**
+ * Move the clock on to the next event and deliver it.
+ *
+ * @return uint8_t 0 if nothing is scheduled
+ */
+static uint8_t deliver_next_event(void) {
+  struct AppTimer *timer = NULL;
+  struct Animation *animation = NULL;
+  uint64_t due = UINT64_MAX;
+  uint8_t i;
+
+  for (i = 0; i < MAX_TIMERS; i++) {
+    if (timers[i].active && timers[i].due < due) {
+      timer = &timers[i];
+      due = timer->due;
+    }
+  }
+  for (i = 0; i < MAX_ANIMATIONS; i++) {
+    if (animations[i].scheduled && animations[i].due < due) {
+      animation = &animations[i];
+      timer = NULL;
+      due = animation->due;
+    }
+  }
+  if (sending && in_flight_due <= due && (!tick_handler || in_flight_due <= next_tick_ms)) {
+    now_ms = in_flight_due;
+    deliver_outbox();
+    return 1;
+  }
+  if (tick_handler && next_tick_ms < due) {
+    time_t seconds = HOST_EPOCH + next_tick_ms / 1000;
+    struct tm *tick_time = localtime(&seconds);
+    now_ms = next_tick_ms;
+    next_tick_ms += 60000;
+    host_counters.tick_wakeups++;
+    tick_handler(tick_time, MINUTE_UNIT | (tick_time->tm_min == 0 ? HOUR_UNIT : 0));
+    return 1;
+  }
+  if (due == UINT64_MAX) {
+    return 0;
+  }
+
+  now_ms = due;
+  if (timer) {
+    timer->active = false;
+    host_counters.timer_wakeups++;
+    timer->callback(timer->data);
+  } else {
+    // the scheduler keeps to its own period however late an update is delivered
+    animation->next += host_animation_interval_ms;
+    animation->due = animation->next + latency();
+    if (animation->due < now_ms) {
+      animation->due = now_ms;
+    }
+    host_counters.animation_wakeups++;
+    animation->implementation->update((Animation *) animation, 0);
+  }
+  return 1;
+}
+
+/**
+ * Run the event loop until the window has been redrawn once.
+ *
+ * @return uint8_t 0 if nothing is left to happen
+ */
+uint8_t host_step(void) {
+  while (!dirty) {
+    if (!deliver_next_event()) {
+      return 0;
+    }
+  }
+  render();
+  return 1;
+}
+
+/* ----- Logging, time and trigonometry ----- */
+
+void app_log(uint8_t level, const char *filename, int line, const char *fmt, ...) {
+  va_list args;
+
+  if (!host_verbose) {
+    return;
+  }
+  va_start(args, fmt);
+  printf("[%llu] %s:%d ", (unsigned long long) now_ms, filename, line);
+  vprintf(fmt, args);
+  printf("\n");
+  va_end(args);
+}
+
+time_t host_time(time_t *t) {
+  time_t seconds = HOST_EPOCH + now_ms / 1000;
+  if (t) {
+    *t = seconds;
+  }
+  return seconds;
+}
+
+uint16_t time_ms(time_t *t, uint16_t *out_ms) {
+  uint16_t ms = now_ms % 1000;
+  host_time(t);
+  if (out_ms) {
+    *out_ms = ms;
+  }
+  return ms;
+}
+
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler) {
+  tick_handler = handler;
+  next_tick_ms = (now_ms / 60000 + 1) * 60000;
+}
+
+void tick_timer_service_unsubscribe(void) {
+  tick_handler = NULL;
+}
+
+int32_t sin_lookup(int32_t angle) {
+  return (int32_t) lround(sin(2 * M_PI * (angle % TRIG_MAX_ANGLE) / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO);
+}
+
+int32_t cos_lookup(int32_t angle) {
+  return (int32_t) lround(cos(2 * M_PI * (angle % TRIG_MAX_ANGLE) / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO);
+}
+
+int32_t atan2_lookup(int16_t y, int16_t x) {
+  double angle = atan2(y, x);
+  if (angle < 0) {
+    angle += 2 * M_PI;
+  }
+  return (int32_t) (angle * TRIG_MAX_ANGLE / (2 * M_PI)) % TRIG_MAX_ANGLE;
+}
+
+/* ----- Layers and drawing ----- */
+
+Layer *layer_create(GRect frame) {
+  Layer *layer = calloc(1, sizeof(Layer));
+  layer->frame = frame;
+  return layer;
+}
+
+void layer_destroy(Layer *layer) {
+  free(layer);
+}
+
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc) {
+  layer->update_proc = update_proc;
+}
+
+void layer_add_child(Layer *parent, Layer *child) {
+  if (parent->child_count < MAX_CHILDREN) {
+    parent->children[parent->child_count++] = child;
+  }
+}
+
+void layer_mark_dirty(Layer *layer) {
+  host_counters.dirty_marks++;
+  dirty = true;
+}
+
+void layer_set_frame(Layer *layer, GRect frame) {
+  layer->frame = frame;
+  dirty = true;
+}
+
+GRect layer_get_bounds(const Layer *layer) {
+  return GRect(0, 0, layer->frame.size.w, layer->frame.size.h);
+}
+
+GRect layer_get_unobstructed_bounds(const Layer *layer) {
+  GRect bounds = layer_get_bounds(layer);
+  if (bounds.size.h > unobstructed_h - layer->frame.origin.y) {
+    bounds.size.h = unobstructed_h - layer->frame.origin.y;
+  }
+  return bounds;
+}
+
+TextLayer *text_layer_create(GRect frame) {
+  TextLayer *text_layer = calloc(1, sizeof(TextLayer));
+  text_layer->layer.frame = frame;
+  text_layer->layer.text = true;
+  return text_layer;
+}
+
+void text_layer_destroy(TextLayer *text_layer) {
+  free(text_layer);
+}
+
+Layer *text_layer_get_layer(TextLayer *text_layer) {
+  return &text_layer->layer;
+}
+
+void text_layer_set_text(TextLayer *text_layer, const char *text) {
+  text_layer->text = text;
+  dirty = true;
+}
+
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment) {
+}
+
+void text_layer_set_background_color(TextLayer *text_layer, GColor color) {
+}
+
+void text_layer_set_text_color(TextLayer *text_layer, GColor color) {
+}
+
+void graphics_context_set_fill_color(GContext *ctx, GColor color) {
+  ctx->fill = color;
+}
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color) {
+  ctx->stroke = color;
+}
+
+static void set_pixel(GContext *ctx, int16_t x, int16_t y, GColor color) {
+  x += ctx->offset.x;
+  y += ctx->offset.y;
+  if (color == GColorClear || x < 0 || y < 0 || x >= HOST_SCREEN_W || y >= HOST_SCREEN_H) {
+    return;
+  }
+  framebuffer[y][x] = color == GColorWhite;
+  host_counters.pixels_drawn++;
+}
+
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask) {
+  int16_t x, y;
+  host_counters.draw_calls++;
+  if (!host_rasterize) {
+    return;
+  }
+  for (y = rect.origin.y; y < rect.origin.y + rect.size.h; y++) {
+    for (x = rect.origin.x; x < rect.origin.x + rect.size.w; x++) {
+      set_pixel(ctx, x, y, ctx->fill);
+    }
+  }
+}
+
+void graphics_draw_rect(GContext *ctx, GRect rect) {
+  int16_t x, y;
+  host_counters.draw_calls++;
+  if (!host_rasterize) {
+    return;
+  }
+  for (x = rect.origin.x; x < rect.origin.x + rect.size.w; x++) {
+    set_pixel(ctx, x, rect.origin.y, ctx->stroke);
+    set_pixel(ctx, x, rect.origin.y + rect.size.h - 1, ctx->stroke);
+  }
+  for (y = rect.origin.y + 1; y < rect.origin.y + rect.size.h - 1; y++) {
+    set_pixel(ctx, rect.origin.x, y, ctx->stroke);
+    set_pixel(ctx, rect.origin.x + rect.size.w - 1, y, ctx->stroke);
+  }
+}
+
+void graphics_fill_circle(GContext *ctx, GPoint p, uint16_t radius) {
+  int16_t x, y, r = radius;
+  host_counters.draw_calls++;
+  if (!host_rasterize) {
+    return;
+  }
+  for (y = -r; y <= r; y++) {
+    for (x = -r; x <= r; x++) {
+      if (x * x + y * y <= r * r) {
+        set_pixel(ctx, p.x + x, p.y + y, ctx->fill);
+      }
+    }
+  }
+}
+
+/** Pixels of an arc, kept because the same arcs are drawn on every frame */
+typedef struct {
+  GRect rect;
+  uint16_t inset_thickness;
+  int32_t angle_start, angle_end;
+  uint16_t count;
+  GPoint *pixels;
+} RadialMask;
+
+static RadialMask radial_masks[4];
+static uint8_t radial_mask_count;
+
+static bool in_angle(int32_t angle, int32_t start, int32_t end) {
+  int32_t turns;
+  for (turns = -1; turns <= 1; turns++) {
+    if (angle + turns * TRIG_MAX_ANGLE >= start && angle + turns * TRIG_MAX_ANGLE <= end) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static RadialMask *radial_mask(GRect rect, uint16_t inset_thickness, int32_t angle_start, int32_t angle_end) {
+  double outer = (rect.size.w < rect.size.h ? rect.size.w : rect.size.h) / 2.0;
+  double cx = rect.origin.x + rect.size.w / 2.0, cy = rect.origin.y + rect.size.h / 2.0;
+  RadialMask *mask;
+  int16_t x, y;
+  uint8_t i;
+
+  for (i = 0; i < radial_mask_count; i++) {
+    mask = &radial_masks[i];
+    if (!memcmp(&mask->rect, &rect, sizeof(rect)) && mask->inset_thickness == inset_thickness &&
+        mask->angle_start == angle_start && mask->angle_end == angle_end) {
+      return mask;
+    }
+  }
+
+  mask = &radial_masks[radial_mask_count < ARRAY_LENGTH(radial_masks) ? radial_mask_count++ : 0];
+  free(mask->pixels);
+  *mask = (RadialMask) { rect, inset_thickness, angle_start, angle_end, 0, malloc(sizeof(GPoint) * rect.size.w * rect.size.h) };
+  for (y = rect.origin.y; y < rect.origin.y + rect.size.h; y++) {
+    for (x = rect.origin.x; x < rect.origin.x + rect.size.w; x++) {
+      double dx = x + 0.5 - cx, dy = y + 0.5 - cy;
+      double distance = sqrt(dx * dx + dy * dy);
+      // clockwise from 12 o'clock, like the SDK
+      int32_t angle = (int32_t) (atan2(dx, -dy) * TRIG_MAX_ANGLE / (2 * M_PI));
+      if (distance <= outer && distance >= outer - inset_thickness && in_angle(angle, angle_start, angle_end)) {
+        mask->pixels[mask->count++] = GPoint(x, y);
+      }
+    }
+  }
+  return mask;
+}
+
+void graphics_fill_radial(GContext *ctx, GRect rect, GOvalScaleMode scale_mode, uint16_t inset_thickness, int32_t angle_start, int32_t angle_end) {
+  RadialMask *mask;
+  uint16_t i;
+
+  host_counters.draw_calls++;
+  if (!host_rasterize) {
+    return;
+  }
+  mask = radial_mask(rect, inset_thickness, angle_start, angle_end);
+  for (i = 0; i < mask->count; i++) {
+    set_pixel(ctx, mask->pixels[i].x, mask->pixels[i].y, ctx->fill);
+  }
+}
+
+/* ----- Windows ----- */
+
+Window *window_create(void) {
+  Window *window = calloc(1, sizeof(Window));
+  window->root.frame = GRect(0, 0, HOST_SCREEN_W, HOST_SCREEN_H);
+  window->background = GColorWhite;
+  return window;
+}
+
+void window_destroy(Window *window) {
+  if (window->loaded && window->handlers.unload) {
+    window->handlers.unload(window);
+  }
+  if (top_window == window) {
+    top_window = NULL;
+  }
+  free(window);
+}
+
+void window_set_window_handlers(Window *window, WindowHandlers handlers) {
+  window->handlers = handlers;
+}
+
+void window_set_background_color(Window *window, GColor background_color) {
+  window->background = background_color;
+  dirty = true;
+}
+
+Layer *window_get_root_layer(const Window *window) {
+  return (Layer *) &window->root;
+}
+
+void window_stack_push(Window *window, bool animated) {
+  top_window = window;
+  if (!window->loaded && window->handlers.load) {
+    window->handlers.load(window);
+  }
+  window->loaded = true;
+  dirty = true;
+}
+
+/* ----- Timers and animations ----- */
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data) {
+  uint8_t i;
+  for (i = 0; i < MAX_TIMERS; i++) {
+    if (!timers[i].active) {
+      timers[i].active = true;
+      timers[i].due = now_ms + timeout_ms + latency();
+      timers[i].callback = callback;
+      timers[i].data = callback_data;
+      return &timers[i];
+    }
+  }
+  return NULL;
+}
+
+void app_timer_cancel(AppTimer *timer) {
+  timer->active = false;
+}
+
+Animation *animation_create(void) {
+  uint8_t i;
+  for (i = 0; i < MAX_ANIMATIONS; i++) {
+    if (!animations[i].used) {
+      animations[i].used = true;
+      return &animations[i];
+    }
+  }
+  return NULL;
+}
+
+void animation_destroy(Animation *animation) {
+  memset(animation, 0, sizeof(*animation));
+}
+
+void animation_set_implementation(Animation *animation, const AnimationImplementation *implementation) {
+  animation->implementation = implementation;
+}
+
+void animation_set_duration(Animation *animation, uint32_t duration_ms) {
+}
+
+void animation_schedule(Animation *animation) {
+  animation->scheduled = true;
+  animation->next = now_ms + host_animation_interval_ms;
+  animation->due = animation->next + latency();
+}
+
+void animation_unschedule(Animation *animation) {
+  animation->scheduled = false;
+}
+
+#ifdef PBL_SDK_3
+void unobstructed_area_service_subscribe(UnobstructedAreaHandlers handlers, void *context) {
+  unobstructed_handlers = handlers;
+  unobstructed_context = context;
+}
+
+void unobstructed_area_service_unsubscribe(void) {
+  memset(&unobstructed_handlers, 0, sizeof(unobstructed_handlers));
+}
+#endif
+
+/* ----- Messaging ----- */
+
+void app_sync_init(AppSync *s, uint8_t *buffer, const uint16_t buffer_size, const Tuplet * const keys_and_initial_values, const uint8_t count,
+  AppSyncTupleChangedCallback tuple_changed_callback, AppSyncErrorCallback error_callback, void *context) {
+  uint8_t i;
+
+  sync_changed = tuple_changed_callback;
+  sync_context = context;
+  // Like the SDK, report the initial values as changes
+  for (i = 0; i < count; i++) {
+    host_sync_setting(keys_and_initial_values[i].key, keys_and_initial_values[i].integer);
+  }
+}
+
+void app_sync_deinit(AppSync *s) {
+  sync_changed = NULL;
+}
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound) {
+  outbox_open = true;
+  return APP_MSG_OK;
+}
+
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator) {
+  if (!outbox_open) {
+    return APP_MSG_BUSY;
+  }
+  if (sending) {
+    host_counters.messages_refused++;
+    return APP_MSG_BUSY;
+  }
+  outbox.count = 0;
+  *iterator = &outbox;
+  return APP_MSG_OK;
+}
+
+DictionaryResult dict_write_data(DictionaryIterator *iter, const uint32_t key, const uint8_t * const data, const uint16_t size) {
+  if (iter->count == MAX_TUPLES || size > sizeof(iter->data[0])) {
+    return DICT_NOT_ENOUGH_STORAGE;
+  }
+  iter->keys[iter->count] = key;
+  memcpy(iter->data[iter->count], data, size);
+  iter->lengths[iter->count] = size;
+  iter->count++;
+  return DICT_OK;
+}
+
+AppMessageResult app_message_outbox_send(void) {
+  uint8_t i;
+
+  // A dictionary is a count byte, then a 7 byte header per tuple
+  host_counters.message_bytes += 1;
+  for (i = 0; i < outbox.count; i++) {
+    host_counters.message_bytes += 7 + outbox.lengths[i];
+  }
+  host_counters.messages_sent++;
+
+  // The outbox stays busy until the phone has the message
+  in_flight = outbox;
+  in_flight_due = outbox_arrival(now_ms);
+  sending = true;
+  if (in_flight_due == now_ms) {
+    deliver_outbox();
+  }
+  return APP_MSG_OK;
+}
+
+void app_event_loop(void) {
+  host_run();
+}
@@ -0,0 +1,150 @@
+/**
+ * Cover and uncover the bottom of the screen mid-rally, as a timeline peek
+ * does, and check that the game takes it in its stride.
+ *
+ * Usage: relayout [-t hours] [-v]
+ *
+ * Each time the screen changes size while the ball is crossing the middle of
+ * the table, checks that:
+ *   - the redraw the change causes does not move the game on (only the frame
+ *     clock does)
+ *   - the rally continues (the ball keeps its course rather than being served
+ *     again, and stays on the table)
+ *   - the keepout is not solved in the change callback, but exactly once, on
+ *     the next frame
+ * and, over the whole run, that no accidental miss follows. Exits non-zero on
+ * the first failed check.
+ */
+#include <getopt.h>
+#include "host.h"
+
+// Time (in ms) between screen size changes
+#define CHANGE_INTERVAL 3700
+
+static uint32_t hours = 2; /**< How long to play for (virtual time) */
+static int status;
+
+/**
+ * Report a failed check.
+ *
+ * @param what What went wrong
+ */
+static void fail(const char *what, const HostGame *game) {
+  printf("%s at %llu ms: ball (%d, %d) vector (%d, %d)\n", what, (unsigned long long) host_now_ms(),
+    game->ball.x, game->ball.y, (int) game->ball_dx, (int) game->ball_dy);
+  status = 1;
+}
+
+/**
+ * Change the screen size and check the frames around the change.
+ *
+ * @param h New unobstructed height
+ */
+static void change_size(int16_t h) {
+  HostGame before, moved, after;
+
+  host_game(&before);
+  host_set_unobstructed_height(h);
+  host_game(&after);
+  if (after.keepout_solves != before.keepout_solves) {
+    fail("keepout solved in the change callback", &after);
+  }
+
+  // The change itself redraws the window, which must show the game as it is rather than move it on
+  moved = after;
+  if (!host_step()) {
+    return;
+  }
+  host_game(&after);
+  if (after.frame_count != before.frame_count || after.ball.x != moved.ball.x || after.ball.y != moved.ball.y ||
+      after.left_y != moved.left_y || after.right_y != moved.right_y) {
+    fail("the redraw after the change advanced the game", &after);
+  }
+  if (after.keepout_solves != before.keepout_solves) {
+    fail("keepout solved in the redraw after the change", &after);
+  }
+
+  // The next frame of the frame clock moves the game on
+  if (!host_step()) {
+    return;
+  }
+  host_game(&after);
+  if (after.frame_count != before.frame_count + 1) {
+    fail("no frame after the change", &after);
+  }
+  if (after.keepout_solves != before.keepout_solves + 1) {
+    fail("keepout not solved exactly once on the next frame", &after);
+  }
+  if (after.ball_dx != before.ball_dx || abs(after.ball.x - before.ball.x) > abs((int) before.ball_dx) + 1) {
+    fail("rally did not continue", &after);
+  }
+  if (after.ball.y < 0 || after.ball.y >= h) {
+    fail("ball left the table", &after);
+  }
+
+  // ...and only that once
+  before = after;
+  if (!host_step()) {
+    return;
+  }
+  host_game(&after);
+  if (after.keepout_solves != before.keepout_solves) {
+    fail("keepout solved again", &after);
+  }
+}
+
+void host_run(void) {
+  const uint64_t end_ms = (uint64_t) hours * 3600000;
+  const int16_t w = host_screen_width(), h = host_screen_height();
+  uint64_t next_change_ms = CHANGE_INTERVAL;
+  uint32_t changes = 0, misses = 0;
+  uint8_t peeking = 0;
+  HostGame game;
+
+  host_game(&game);
+  if (!game.relayout) {
+    printf("%s: the table is not re-laid out on this platform\n", HOST_PLATFORM);
+    return;
+  }
+
+  while (host_now_ms() < end_ms && host_step()) {
+    host_game(&game);
+    if (game.failed) {
+      misses++;
+      fail("accidental miss", &game);
+      host_game_clear_failed();
+    }
+
+    // Mid-rally: the ball is in play and crossing the middle third of the table
+    if (host_now_ms() >= next_change_ms && game.started && game.ball_dx != 0 && abs(game.ball.x - w / 2) < w / 6) {
+      peeking = !peeking;
+      change_size(peeking ? h - HOST_PEEK_HEIGHT : h);
+      changes++;
+      next_change_ms = host_now_ms() + CHANGE_INTERVAL;
+    }
+  }
+
+  printf("%s %dx%d: %u h, %u screen size changes mid-rally, %u accidental misses\n", HOST_PLATFORM, w, h,
+    hours, changes, misses);
+}
+
+int main(int argc, char **argv) {
+  int opt;
+
+  while ((opt = getopt(argc, argv, "t:v")) != -1) {
+    switch (opt) {
+      case 't':
+        hours = atoi(optarg);
+        break;
+      case 'v':
+        host_verbose = 1;
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-t hours] [-v]\n", argv[0]);
+        return 2;
+    }
+  }
+
+  pingchrong_main();
+  return status;
+}
@@ -0,0 +1,82 @@
+/**
+ * Play the watchface for a while (in virtual time) and check the AI.
+ *
+ * Usage: sim [-t hours] [-l latency_ms] [-s key=value]... [-v]
+ *
+ * Reports accidental misses (a paddle missing a ball it should have hit, or
+ * hitting one it should have missed) and how much work the watch did, and
+ * exits non-zero if there were any misses. Settings (-s) use the AppSync keys
+ * from appinfo.json and are sent once startup is done.
+ */
+#include <getopt.h>
+#include "host.h"
+
+#define MAX_SETTINGS 8
+
+static uint32_t hours = 6; /**< How long to play for (virtual time) */
+static uint32_t setting_keys[MAX_SETTINGS];
+static int32_t setting_values[MAX_SETTINGS];
+static uint8_t setting_count;
+static int status;
+
+void host_run(void) {
+  const uint64_t end_ms = (uint64_t) hours * 3600000;
+  uint8_t settings_sent = 0;
+  uint32_t misses = 0;
+  HostGame game;
+  uint8_t i;
+
+  while (host_now_ms() < end_ms && host_step()) {
+    host_game(&game);
+    if (game.started && !settings_sent) {
+      for (i = 0; i < setting_count; i++) {
+        host_sync_setting(setting_keys[i], setting_values[i]);
+      }
+      settings_sent = 1;
+    }
+    if (game.failed) {
+      misses++;
+      printf("accidental miss at %llu ms: ball (%d, %d)\n", (unsigned long long) host_now_ms(), game.ball.x, game.ball.y);
+      host_game_clear_failed();
+    }
+  }
+
+  host_game(&game);
+  printf("%s %dx%d: %u h, %u frames, %u accidental misses\n", HOST_PLATFORM, host_screen_width(), host_screen_height(),
+    hours, game.frame_count, misses);
+  printf("  wakeups: %u timer, %u animation, %u tick; %u renders, %.0f rows changed/render, %.0f pixels/render\n",
+    host_counters.timer_wakeups, host_counters.animation_wakeups, host_counters.tick_wakeups, host_counters.renders,
+    (double) host_counters.rows_changed / host_counters.renders, (double) host_counters.pixels_drawn / host_counters.renders);
+  status = misses > 0;
+}
+
+int main(int argc, char **argv) {
+  int opt;
+
+  while ((opt = getopt(argc, argv, "t:l:s:v")) != -1) {
+    switch (opt) {
+      case 't':
+        hours = atoi(optarg);
+        break;
+      case 'l':
+        host_timer_latency_ms = atoi(optarg);
+        break;
+      case 's':
+        if (setting_count == MAX_SETTINGS || sscanf(optarg, "%u=%d", &setting_keys[setting_count], &setting_values[setting_count]) != 2) {
+          fprintf(stderr, "bad setting: %s\n", optarg);
+          return 2;
+        }
+        setting_count++;
+        break;
+      case 'v':
+        host_verbose = 1;
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-t hours] [-l latency_ms] [-s key=value]... [-v]\n", argv[0]);
+        return 2;
+    }
+  }
+
+  pingchrong_main();
+  return status;
+}
@@ -0,0 +1,43 @@
+/**
+ * The watchface built for the watch's CPU (Cortex-M3, Thumb-2), with an entry
+ * point for each of the hot paths thumb_count.js measures.
+ *
+ * Like game.c, this includes the source so its static functions can be
+ * reached; each thumb_* wrapper is what the compiler makes of one of them
+ * (it is usually inlined into the wrapper, as it is into its callers on the
+ * watch). Only compiled, never run: see make thumb.
+ */
+#include <pebble.h>
+
+#define main pingchrong_main
+#include "../../src/pingchrong.c"
+#undef main
+
+void thumb_encipher(void) {
+  encipher();
+}
+
+uint16_t thumb_crand(uint8_t type) {
+  return crand(type);
+}
+
+uint8_t thumb_calculate_keepout(int8_t dir, float x, float y, float dx, float dy, uint8_t *keepout1, uint8_t *keepout2) {
+  return calculate_keepout((dir < 0) ? &left_side : &right_side, x, y, dx, dy, keepout1, keepout2);
+}
+
+uint8_t thumb_intersectrect(uint8_t x1, uint8_t y1, uint8_t w1, uint8_t h1, uint8_t x2, uint8_t y2, uint8_t w2, uint8_t h2) {
+  return intersectrect(x1, y1, w1, h1, x2, y2, w2, h2);
+}
+
+int thumb_safe_cos(float angle) {
+  return safe_cos(angle);
+}
+
+int thumb_safe_sin(float angle) {
+  return safe_sin(angle);
+}
+
+/** One full frame: the game step and drawing, as the animation layer's update proc */
+void thumb_frame(Layer *me, GContext *ctx) {
+  anim_layer_update_callback(me, ctx);
+}
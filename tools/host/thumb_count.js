@@ -0,0 +1,141 @@
+/**
+ * Static Thumb-2 instruction counts for the hot paths in thumb.c.
+ *
+ * Reads `llvm-objdump -dr` listings of thumb.c built for each platform
+ * (make thumb) and, for each thumb_* entry point, counts the instructions and
+ * code bytes of every function it can reach in the watchface, the calls it
+ * makes to the soft-float helpers (the watch's Cortex-M3 has no FPU, so each
+ * float operation is a call into libgcc) and its other calls out (SDK and
+ * libc). Literal pools are not counted. An entry that only tail-calls one
+ * function is counted from that function, so the wrapper's own argument
+ * shuffling is left out.
+ *
+ * These are counts of the code, not of what runs: loops are counted once and
+ * both sides of every branch are counted.
+ *
+ * Usage: node thumb_count.js <platform>=<listing> ...  (prints JSON)
+ *        node thumb_count.js --compare <baseline.json> <current.json> [percent]
+ *
+ * With --compare, exits non-zero if any entry in the baseline grew by more
+ * than percent (0 by default) in instructions or code bytes, or makes more
+ * soft-float calls than it did.
+ */
+var fs = require("fs");
+
+var ENTRY_PREFIX = "thumb_",
+    SOFT_FLOAT = /^__aeabi_(f|d|c[fd]|[ui]?l?2[fd])/;
+
+function parseListing(text) {
+  var functions = {},
+      current = null,
+      lines = text.split("\n"),
+      i, match;
+
+  for(i = 0; i < lines.length; i++) {
+    if((match = /^[0-9a-f]+ <([^>]+)>:$/.exec(lines[i]))) {
+      current = functions[match[1]] = {instructions: 0, bytes: 0, calls: [], tail: []};
+    } else if(!current) {
+      continue;
+    } else if((match = /R_ARM_THM_(CALL|JUMP\d+)\s+(\S+)/.exec(lines[i]))) {
+      (match[1] === "CALL" ? current.calls : current.tail).push(match[2]);
+    } else if((match = /^\s*[0-9a-f]+:\s+((?:[0-9a-f]{2} )+)\s*(\S+)/.exec(lines[i]))) {
+      if(match[2].charAt(0) !== ".") {
+        current.instructions++;
+        current.bytes += match[1].trim().split(" ").length;
+      }
+    }
+  }
+  return functions;
+}
+
+function countEntry(functions, name) {
+  var entry = functions[name],
+      result = {instructions: 0, bytes: 0, functions: [], soft_float_calls: 0, soft_float: {}, calls: {}},
+      pending, seen = {}, fn, callees, i;
+
+  if(entry.calls.length === 0 && entry.tail.length === 1 && functions[entry.tail[0]]) {
+    name = entry.tail[0];
+  }
+  pending = [name];
+  while(pending.length) {
+    name = pending.pop();
+    if(seen[name]) {
+      continue;
+    }
+    seen[name] = true;
+    fn = functions[name];
+    result.functions.push(name);
+    result.instructions += fn.instructions;
+    result.bytes += fn.bytes;
+    callees = fn.calls.concat(fn.tail);
+    for(i = 0; i < callees.length; i++) {
+      if(functions[callees[i]]) {
+        pending.push(callees[i]);
+      } else if(SOFT_FLOAT.test(callees[i])) {
+        result.soft_float[callees[i]] = (result.soft_float[callees[i]] || 0) + 1;
+        result.soft_float_calls++;
+      } else {
+        result.calls[callees[i]] = (result.calls[callees[i]] || 0) + 1;
+      }
+    }
+  }
+  result.functions.sort();
+  return result;
+}
+
+function count(argv) {
+  var counts = {}, i, split, functions, name;
+
+  for(i = 2; i < argv.length; i++) {
+    split = argv[i].indexOf("=");
+    functions = parseListing(fs.readFileSync(argv[i].substr(split + 1), "utf8"));
+    counts[argv[i].substr(0, split)] = {};
+    for(name in functions) {
+      if(name.indexOf(ENTRY_PREFIX) === 0) {
+        counts[argv[i].substr(0, split)][name.substr(ENTRY_PREFIX.length)] = countEntry(functions, name);
+      }
+    }
+  }
+  console.log(JSON.stringify(counts, null, 2));
+  return 0;
+}
+
+function grew(now, then, percent) {
+  return now > then * (1 + percent / 100);
+}
+
+function compare(argv) {
+  var baseline = JSON.parse(fs.readFileSync(argv[3], "utf8")),
+      current = JSON.parse(fs.readFileSync(argv[4], "utf8")),
+      percent = argv[5] ? parseFloat(argv[5]) : 0,
+      failed = 0,
+      platform, entry, then, now, verdict;
+
+  for(platform in baseline) {
+    for(entry in baseline[platform]) {
+      then = baseline[platform][entry];
+      now = current[platform] && current[platform][entry];
+      if(!now) {
+        console.log(platform + " " + entry + ": missing");
+        failed++;
+        continue;
+      }
+      verdict = "";
+      if(grew(now.instructions, then.instructions, percent) || grew(now.bytes, then.bytes, percent)) {
+        verdict = "  GREW";
+      }
+      if(now.soft_float_calls > then.soft_float_calls) {
+        verdict += "  MORE SOFT-FLOAT";
+      }
+      console.log(platform + " " + entry + ": " + now.instructions + " instructions (" + then.instructions +
+        "), " + now.bytes + " bytes (" + then.bytes + "), " + now.soft_float_calls + " soft-float calls (" +
+        then.soft_float_calls + ")" + verdict);
+      if(verdict) {
+        failed++;
+      }
+    }
+  }
+  return failed ? 1 : 0;
+}
+
+process.exit(process.argv[2] === "--compare" ? compare(process.argv) : count(process.argv));
@@ -0,0 +1,92 @@
+/**
+ * Time to first frame: how long the watchface takes from launch until the
+ * first frame is on screen, until AppMessage is open (settings the phone sends
+ * before then are lost) and until the ball is in play.
+ *
+ * Usage: ttff [-n runs]
+ *
+ * Each run is a fresh process (the watchface keeps its state in statics).
+ * Virtual times are what the watch would show; CPU times are host wall-clock
+ * time spent in the watchface's code, a stand-in for the work the watch does
+ * before each milestone. Build with BASE=<rev> to compare against an older
+ * revision.
+ */
+#include <getopt.h>
+#include "host.h"
+
+#define MAX_RUNS 64
+
+/** Timings of one launch */
+typedef struct {
+  uint64_t first_frame_ms; /**< Virtual time of the first frame */
+  uint64_t inbox_ms; /**< Virtual time AppMessage was opened (settings sent before then are lost) */
+  uint64_t started_ms; /**< Virtual time the ball was in play */
+  double first_frame_us; /**< CPU time until the first frame was drawn */
+  double started_us; /**< CPU time until the ball was in play */
+} Launch;
+
+static Launch launch;
+
+static double elapsed_us(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - host_launched.tv_sec) * 1e6 + (now.tv_nsec - host_launched.tv_nsec) / 1e3;
+}
+
+void host_run(void) {
+  HostGame game;
+
+  host_step();
+  launch.first_frame_us = elapsed_us();
+  launch.first_frame_ms = host_now_ms();
+  while (!host_app_message_open() && host_step()) {
+  }
+  launch.inbox_ms = host_now_ms();
+  host_start_game(&game);
+  launch.started_us = elapsed_us();
+  launch.started_ms = host_now_ms();
+}
+
+static int compare_doubles(const void *a, const void *b) {
+  double x = *(const double *) a, y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+static double median(double *values, int count) {
+  qsort(values, count, sizeof(double), compare_doubles);
+  return values[count / 2];
+}
+
+int main(int argc, char **argv) {
+  double first_frame_us[MAX_RUNS], started_us[MAX_RUNS];
+  int runs = 15, opt, i;
+
+  while ((opt = getopt(argc, argv, "n:")) != -1) {
+    if (opt != 'n') {
+      fprintf(stderr, "usage: %s [-n runs]\n", argv[0]);
+      return 2;
+    }
+    runs = atoi(optarg);
+    if (runs < 1 || runs > MAX_RUNS) {
+      fprintf(stderr, "runs must be 1..%d\n", MAX_RUNS);
+      return 2;
+    }
+  }
+
+  for (i = 0; i < runs; i++) {
+    if (!host_launch(&launch, sizeof(launch))) {
+      fprintf(stderr, "run %d failed\n", i);
+      return 1;
+    }
+    first_frame_us[i] = launch.first_frame_us;
+    started_us[i] = launch.started_us;
+    if (i == 0) {
+      printf("%s: first frame at %llu ms, AppMessage open at %llu ms, ball in play at %llu ms (virtual)\n", HOST_PLATFORM,
+        (unsigned long long) launch.first_frame_ms, (unsigned long long) launch.inbox_ms, (unsigned long long) launch.started_ms);
+      printf("  cold run: first frame %.1f us, ball in play %.1f us (host CPU)\n", first_frame_us[0], started_us[0]);
+    }
+  }
+  printf("  median of %d: first frame %.1f us, ball in play %.1f us (host CPU)\n", runs,
+    median(first_frame_us, runs), median(started_us, runs));
+  return 0;
+}
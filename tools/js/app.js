@@ -0,0 +1,60 @@
+/**
+ * Loads pebble-js-app.js the way the Pebble app does, against a fake Pebble
+ * and window, for the local tests in this directory.
+ */
+var fs = require("fs"),
+    path = require("path"),
+    vm = require("vm");
+
+/**
+ * @param {Object} [stored] localStorage contents to start with
+ * @return {Object} The app's event listeners, its window, its localStorage,
+ *   the URLs it opened, the messages it sent and the sockets it opened (which
+ *   never connect)
+ */
+exports.load = function(stored) {
+  var app = {
+    listeners: {},
+    storage: stored || {},
+    openedUrls: [],
+    sentMessages: [],
+    sockets: []
+  };
+
+  app.window = {
+    localStorage: {
+      getItem: function(key) {
+        return app.storage.hasOwnProperty(key) ? app.storage[key] : null;
+      },
+      setItem: function(key, value) {
+        app.storage[key] = value;
+      }
+    },
+    WebSocket: function(url) {
+      this.url = url;
+      this.readyState = 0;
+      this.close = function() {
+        this.readyState = 3;
+      };
+      app.sockets.push(this);
+    }
+  };
+
+  vm.runInNewContext(fs.readFileSync(path.join(__dirname, "../../src/js/pebble-js-app.js"), "utf8"), {
+    Pebble: {
+      addEventListener: function(name, callback) {
+        app.listeners[name] = callback;
+      },
+      sendAppMessage: function(message) {
+        app.sentMessages.push(message);
+      },
+      openURL: function(url) {
+        app.openedUrls.push(url);
+      }
+    },
+    window: app.window,
+    setInterval: setInterval,
+    clearInterval: clearInterval
+  });
+  return app;
+};
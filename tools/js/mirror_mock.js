@@ -0,0 +1,85 @@
+/**
+ * Local mock of the phone side of mirroring.
+ *
+ * Loads pebble-js-app.js with a fake Pebble and window, replays the keyframes
+ * recorded by the host harness (tools/host mirror) through its appmessage
+ * handler, and compares the state it rebuilds for every frame with where the
+ * ball and paddles really were on the watch. A keyframe is replayed when the
+ * recording says it reached the phone, so a recording made with latency or
+ * busy periods shows how far the phone falls behind meanwhile.
+ *
+ * Usage: node mirror_mock.js <recording> [max error in pixels]
+ *
+ * Exits non-zero if the rebuilt state is ever off by more than the max error
+ * (0 by default).
+ */
+var fs = require("fs"),
+    app = require("./app");
+
+// Size of a keyframe as an AppMessage dictionary: count byte, tuple header, data
+var KEYFRAME_MESSAGE_SIZE = 1 + 7 + 37;
+
+function hexBytes(hex) {
+  var bytes = [], i;
+  for(i = 0; i < hex.length; i += 2) {
+    bytes.push(parseInt(hex.substr(i, 2), 16));
+  }
+  return bytes;
+}
+
+function main(argv) {
+  var pebble = app.load(),
+      lines = fs.readFileSync(argv[2], "utf8").split("\n"),
+      allowed = argv[3] ? parseInt(argv[3], 10) : 0,
+      frameTime = 50,
+      keyframes = 0,
+      refused = 0,
+      frames = 0,
+      framesOff = 0,
+      maxError = 0,
+      worst = null,
+      i, fields, state, error, minutes;
+
+  pebble.listeners.ready({});
+  for(i = 0; i < lines.length; i++) {
+    fields = lines[i].split(" ");
+    if(fields[0] === "T") {
+      frameTime = parseInt(fields[1], 10);
+    } else if(fields[0] === "K") {
+      pebble.listeners.appmessage({ payload: { mirrorKeyframe: hexBytes(fields[2]) } });
+      keyframes++;
+    } else if(fields[0] === "R") {
+      refused = parseInt(fields[1], 10);
+    } else if(fields[0] === "F") {
+      fields = fields.slice(1).map(Number);
+      state = pebble.window.pingchrongMirror.stateAt(fields[0]);
+      if(!state) {
+        // nothing to mirror before the first keyframe
+        continue;
+      }
+      frames++;
+      error = Math.max(Math.abs(state.ball.x - fields[1]), Math.abs(state.ball.y - fields[2]),
+                       Math.abs(state.leftPaddleY - fields[3]), Math.abs(state.rightPaddleY - fields[4]));
+      if(error > 0) {
+        framesOff++;
+      }
+      if(error > maxError) {
+        maxError = error;
+        worst = { frame: fields[0], watch: fields.slice(1), phone: [state.ball.x, state.ball.y, state.leftPaddleY, state.rightPaddleY] };
+      }
+    }
+  }
+
+  minutes = frames * frameTime / 60000;
+  console.log("%d frames (%s min at %d ms), %d keyframes (%d turned away by a busy outbox and sent later)",
+              frames, minutes.toFixed(1), frameTime, keyframes, refused);
+  console.log("  %s keyframes/min, %d bytes/min (full state every frame would be %d bytes/min)", (keyframes / minutes).toFixed(1),
+              Math.round(keyframes * KEYFRAME_MESSAGE_SIZE / minutes), Math.round(60000 / frameTime * KEYFRAME_MESSAGE_SIZE));
+  console.log("  max error %d px, %d frames off", maxError, framesOff);
+  if(worst) {
+    console.log("  worst at frame %d: watch %j, phone %j", worst.frame, worst.watch, worst.phone);
+  }
+  process.exit(maxError > allowed ? 1 : 0);
+}
+
+main(process.argv);
@@ -0,0 +1,245 @@
+/**
+ * Time-to-interactive test for the settings page, in headless Chrome.
+ *
+ * Opens the page exactly as the app does (the data URI passed to openURL by
+ * showConfiguration), waits until it is interactive, checks that it shows
+ * the stored settings, then saves and checks that the settings come back
+ * through webviewclosed unchanged. Then checks that stored values the page
+ * does not offer show, and are saved, as the defaults.
+ *
+ * Usage: node settings_tti.js [runs]
+ *
+ * Chrome is found through $CHROME, the PATH, or puppeteer's download cache.
+ * Exits non-zero if a check fails, and with 77 (skip) if Chrome is missing.
+ */
+var childProcess = require("child_process"),
+    fs = require("fs"),
+    os = require("os"),
+    path = require("path"),
+    app = require("./app");
+
+// Settings to round-trip; every field on the page is set to something other than its default
+var STORED = {
+  "12hTime": 1,
+  "inverted": 1,
+  "mirror": 1,
+  "mirrorUrl": "ws://192.168.1.2:8080",
+  "ballSpeed": 75,
+  "paddleSize": 30,
+  "paddleSpeed": 20,
+  "frameTime": 33
+};
+
+// Stored values the page does not offer, and the defaults it should fall back to
+var UNOFFERED = { "ballSpeed": 60, "frameTime": 40 },
+    DEFAULTS = { "ballSpeed": 100, "frameTime": 50 };
+
+function findChrome() {
+  var names = ["google-chrome", "chromium", "chromium-browser", "chrome", "chrome-headless-shell"],
+      cache = path.join(os.homedir(), ".cache/puppeteer"),
+      dirs = (process.env.PATH || "").split(path.delimiter),
+      candidates = [],
+      i, j;
+
+  if(process.env.CHROME) {
+    return process.env.CHROME;
+  }
+  for(i = 0; i < dirs.length; i++) {
+    for(j = 0; j < names.length; j++) {
+      candidates.push(path.join(dirs[i], names[j]));
+    }
+  }
+  ["chrome-headless-shell", "chrome"].forEach(function(product) {
+    var dir = path.join(cache, product);
+    if(fs.existsSync(dir)) {
+      fs.readdirSync(dir).forEach(function(version) {
+        fs.readdirSync(path.join(dir, version)).forEach(function(build) {
+          candidates.push(path.join(dir, version, build, product));
+        });
+      });
+    }
+  });
+  return candidates.filter(function(candidate) {
+    return fs.existsSync(candidate);
+  })[0];
+}
+
+/**
+ * Minimal DevTools protocol client, over the pipe Chrome opens on fds 3 and 4.
+ */
+function DevTools(chrome) {
+  var self = this, pending = "";
+
+  this.chrome = chrome;
+  this.nextId = 1;
+  this.calls = {};
+  this.waiters = [];
+  chrome.stdio[4].on("data", function(data) {
+    var messages = (pending + data.toString("utf8")).split("\0");
+    pending = messages.pop();
+    messages.forEach(function(message) {
+      self.receive(JSON.parse(message));
+    });
+  });
+}
+
+DevTools.prototype.receive = function(message) {
+  var call = this.calls[message.id];
+  if(call) {
+    delete this.calls[message.id];
+    if(message.error) {
+      call.reject(new Error(message.error.message));
+    } else {
+      call.resolve(message.result);
+    }
+    return;
+  }
+  this.waiters = this.waiters.filter(function(waiter) {
+    if(message.method === waiter.method && waiter.test(message.params)) {
+      waiter.resolve(message.params);
+      return false;
+    }
+    return true;
+  });
+};
+
+DevTools.prototype.send = function(method, params, sessionId) {
+  var self = this, id = this.nextId++;
+  return new Promise(function(resolve, reject) {
+    self.calls[id] = { resolve: resolve, reject: reject };
+    self.chrome.stdio[3].write(JSON.stringify({ id: id, method: method, params: params || {}, sessionId: sessionId }) + "\0");
+  });
+};
+
+DevTools.prototype.waitFor = function(method, test) {
+  var self = this;
+  return new Promise(function(resolve, reject) {
+    var timeout = setTimeout(function() {
+      reject(new Error("timed out waiting for " + method));
+    }, 10000);
+    self.waiters.push({ method: method, test: test || function() { return true; }, resolve: function(params) {
+      clearTimeout(timeout);
+      resolve(params);
+    } });
+  });
+};
+
+function check(ok, what) {
+  if(!ok) {
+    throw new Error(what);
+  }
+}
+
+async function openSettings(devtools, url) {
+  var target = await devtools.send("Target.createTarget", { url: "about:blank" }),
+      session = (await devtools.send("Target.attachToTarget", { targetId: target.targetId, flatten: true })).sessionId,
+      loaded, result;
+
+  await devtools.send("Page.enable", {}, session);
+  await devtools.send("Runtime.enable", {}, session);
+  loaded = devtools.waitFor("Page.loadEventFired");
+  await devtools.send("Page.navigate", { url: url }, session);
+  await loaded;
+
+  result = await devtools.send("Runtime.evaluate", { returnByValue: true, expression: "(" + function() {
+    var timing = performance.timing, values = {};
+    Array.prototype.forEach.call(document.querySelectorAll("[data-key]"), function(field) {
+      values[field.getAttribute("data-key")] = field.value;
+    });
+    return {
+      interactive: timing.domInteractive - timing.navigationStart,
+      ready: timing.domContentLoadedEventEnd - timing.navigationStart,
+      loaded: timing.loadEventEnd - timing.navigationStart,
+      resources: performance.getEntriesByType("resource").length,
+      error: document.getElementById("error").style.display === "block",
+      values: values
+    };
+  } + ")()" }, session);
+  return { session: session, targetId: target.targetId, page: result.result.value };
+}
+
+async function saveSettings(devtools, session) {
+  var navigation = devtools.waitFor("Page.frameRequestedNavigation", function(params) {
+    return params.url.indexOf("pebblejs://close#") === 0;
+  });
+  await devtools.send("Runtime.evaluate", { expression: "document.getElementById('b-submit').click()" }, session);
+  return (await navigation).url.replace(/^pebblejs:\/\/close#/, "");
+}
+
+async function main(runs) {
+  var chromePath = findChrome(),
+      pebble = app.load({ "pingchrong-settings": JSON.stringify(STORED) }),
+      interactive = [], ready = [],
+      url, chrome, devtools, i, opened, key, response, saved, first;
+
+  if(!chromePath) {
+    console.log("Chrome not found (set CHROME); skipping settings page test");
+    return 77;
+  }
+
+  pebble.listeners.showConfiguration({});
+  url = pebble.openedUrls[0];
+  check(url.indexOf("data:text/html") === 0, "showConfiguration did not open a data URI: " + url.substr(0, 60));
+
+  chrome = childProcess.spawn(chromePath, [
+    "--headless", "--no-sandbox", "--disable-gpu", "--no-first-run", "--remote-debugging-pipe",
+    "--user-data-dir=" + fs.mkdtempSync(path.join(os.tmpdir(), "pingchrong-chrome-"))
+  ], { stdio: ["ignore", "ignore", "ignore", "pipe", "pipe"] });
+  devtools = new DevTools(chrome);
+
+  try {
+    for(i = 0; i < runs; i++) {
+      opened = await openSettings(devtools, url);
+      interactive.push(opened.page.interactive);
+      ready.push(opened.page.ready);
+      if(i < runs - 1) {
+        await devtools.send("Target.closeTarget", { targetId: opened.targetId });
+      }
+    }
+
+    check(!opened.page.error, "page could not read the settings");
+    check(opened.page.resources === 0, "page loaded " + opened.page.resources + " external resources");
+    for(key in STORED) {
+      check(String(STORED[key]) === opened.page.values[key], "page shows " + key + " = " + opened.page.values[key]);
+    }
+
+    response = await saveSettings(devtools, opened.session);
+    pebble.listeners.webviewclosed({ response: response });
+    saved = JSON.parse(pebble.storage["pingchrong-settings"]);
+    for(key in STORED) {
+      check(STORED[key] === saved[key], "saving changed " + key + " to " + saved[key]);
+    }
+    check(pebble.sentMessages.every(function(message) {
+      return !message.hasOwnProperty("mirrorUrl");
+    }), "phone-only setting was sent to the watch");
+
+    pebble = app.load({ "pingchrong-settings": JSON.stringify(UNOFFERED) });
+    pebble.listeners.showConfiguration({});
+    opened = await openSettings(devtools, pebble.openedUrls[0]);
+    for(key in DEFAULTS) {
+      check(String(DEFAULTS[key]) === opened.page.values[key], "page shows unoffered " + key + " as " + opened.page.values[key]);
+    }
+    pebble.listeners.webviewclosed({ response: await saveSettings(devtools, opened.session) });
+    saved = JSON.parse(pebble.storage["pingchrong-settings"]);
+    for(key in DEFAULTS) {
+      check(DEFAULTS[key] === saved[key], "saving unoffered " + key + " gave " + saved[key]);
+    }
+  } finally {
+    chrome.kill();
+  }
+
+  first = interactive[0];
+  interactive.sort(function(a, b) { return a - b; });
+  ready.sort(function(a, b) { return a - b; });
+  console.log("settings page (%d bytes as a data URI): interactive after %d ms, ready after %d ms (median of %d; first run %d ms), 0 external resources",
+              url.length, interactive[runs >> 1], ready[runs >> 1], runs, first);
+  console.log("  settings round-trip: ok; unoffered values fall back to the defaults: ok");
+  return 0;
+}
+
+main(parseInt(process.argv[2] || "9", 10)).then(function(status) {
+  process.exit(status);
+}, function(error) {
+  console.error("settings page test failed: " + error.message);
+  process.exit(1);
+});